@@ -0,0 +1,201 @@
+#pragma once
+
+// Arrays and pointers whose alignment is part of the type
+//
+// Knowing the alignment at compile time lets the compiler use aligned vector loads without a peeling loop,
+// and lets kernels skip checking alignment at runtime.
+
+#include "array.hpp"
+#include "allocator.hpp"
+
+namespace rcom
+{
+	namespace hidden
+	{
+		inline constexpr bool is_power_of_two(size_t n)
+		{
+			return n && (n & (n - 1)) == 0;
+		}
+
+		// Alignment of a pointer offset by bytes from an Align aligned pointer
+		inline constexpr size_t offset_alignment(size_t align, size_t bytes)
+		{
+			return bytes == 0 ? align : (bytes & (~bytes + 1)) < align ? (bytes & (~bytes + 1)) : align;
+		}
+
+		template<size_t Align, typename T> inline T* assume_aligned(T* ptr)
+		{
+#if defined(__GNUC__)
+			return static_cast<T*>(__builtin_assume_aligned(ptr, Align));
+#else
+			return ptr;
+#endif
+		}
+	}
+	// namespace hidden
+
+	// ArrayPtr whose data is known to be aligned to Align bytes
+	// Converts to a plain ArrayPtr, so it can be passed to anything taking one
+	template<typename T, size_t Align> class AlignedArrayPtr : public ArrayPtr<T>
+	{
+	public:
+		static_assert(hidden::is_power_of_two(Align), "Alignment must be a power of two");
+		static_assert(Align >= alignof(T), "Alignment must be at least that of the type");
+
+		constexpr static const size_t alignment = Align;
+
+		inline AlignedArrayPtr();
+		inline AlignedArrayPtr(std::nullptr_t);
+		// ptr must be aligned to Align
+		inline AlignedArrayPtr(T* ptr, size_t n);
+
+		inline operator AlignedArrayPtr<const T, Align>() const;
+
+		// Slice at a compile time offset. Keeps as much of the alignment as the offset allows
+		template<size_t Start> inline AlignedArrayPtr<T, hidden::offset_alignment(Align, Start * sizeof(T))> aligned_slice(size_t end);
+		template<size_t Start> inline AlignedArrayPtr<T, hidden::offset_alignment(Align, Start * sizeof(T))> aligned_slice();
+
+		// Slice at a runtime offset which must be a multiple of Align bytes
+		inline AlignedArrayPtr aligned_slice(size_t start, size_t end);
+
+		inline       T* data();
+		inline const T* data()  const;
+		inline       T* begin();
+		inline const T* begin() const;
+		inline       T* end();
+		inline const T* end()   const;
+	};
+
+	// Array aligned to Align bytes, cache line by default
+	template<typename T, size_t N, size_t Align = RCOM_CACHE_LINE_SIZE> class alignas(Align) AlignedArray : public Array<T, N>
+	{
+	public:
+		static_assert(hidden::is_power_of_two(Align), "Alignment must be a power of two");
+		static_assert(Align >= alignof(T), "Alignment must be at least that of the type");
+
+		constexpr static const size_t alignment = Align;
+
+		inline       AlignedArrayPtr<T, Align>       to_aligned_ptr();
+		inline const AlignedArrayPtr<const T, Align> to_aligned_ptr() const;
+	};
+
+	// Value padded out to its own cache line so neighbouring values written by other threads do not share it
+	template<typename T, size_t Align = RCOM_CACHE_LINE_SIZE> struct alignas(Align) CacheAligned
+	{
+		T value;
+
+		inline       T& operator*()        { return value; }
+		inline const T& operator*()  const { return value; }
+		inline       T* operator->()       { return &value; }
+		inline const T* operator->() const { return &value; }
+	};
+
+	// Allocate count uninitialized elements aligned to Align. Null if allocation failed
+	template<typename T, size_t Align, typename Alloc> inline AlignedArrayPtr<T, Align> allocate_aligned_array(Alloc& alloc, size_t count)
+	{
+		BytePtr mem = alloc.allocate(::byte_size<T>(count), Align);
+		return mem ? AlignedArrayPtr<T, Align>{reinterpret_cast<T*>(mem.data()), count} : AlignedArrayPtr<T, Align>{};
+	}
+
+	// Free an array obtained from allocate_aligned_array. Elements are not destroyed
+	template<typename T, size_t Align, typename Alloc> inline void deallocate_aligned_array(Alloc& alloc, AlignedArrayPtr<T, Align> ptr)
+	{
+		if(ptr)
+		{
+			alloc.deallocate(ptr.to_bytes(), Align);
+		}
+	}
+
+	// Check an ArrayPtr is aligned and convert it. Null if it is not
+	template<size_t Align, typename T> inline AlignedArrayPtr<T, Align> to_aligned_ptr(ArrayPtr<T> ptr)
+	{
+		bool aligned = reinterpret_cast<uintptr_t>(ptr.data()) % Align == 0;
+		return aligned ? AlignedArrayPtr<T, Align>{ptr.data(), ptr.size()} : AlignedArrayPtr<T, Align>{};
+	}
+
+	template<typename T, size_t Align> AlignedArrayPtr<T, Align>::AlignedArrayPtr() :
+		ArrayPtr<T>{}
+	{
+	}
+
+	template<typename T, size_t Align> AlignedArrayPtr<T, Align>::AlignedArrayPtr(std::nullptr_t) :
+		ArrayPtr<T>{}
+	{
+	}
+
+	template<typename T, size_t Align> AlignedArrayPtr<T, Align>::AlignedArrayPtr(T* ptr, size_t n) :
+		ArrayPtr<T>{ptr, n}
+	{
+		RCOM_ASSERT(reinterpret_cast<uintptr_t>(ptr) % Align == 0, "Pointer is not aligned");
+	}
+
+	template<typename T, size_t Align> AlignedArrayPtr<T, Align>::operator AlignedArrayPtr<const T, Align>() const
+	{
+		return {ArrayPtr<T>::data(), ArrayPtr<T>::size()};
+	}
+
+	template<typename T, size_t Align>
+	template<size_t Start> auto AlignedArrayPtr<T, Align>::aligned_slice(size_t end) -> AlignedArrayPtr<T, hidden::offset_alignment(Align, Start * sizeof(T))>
+	{
+		RCOM_ASSERT(end <= ArrayPtr<T>::size(), "Index out of range");
+		RCOM_ASSERT(Start < end,                "Invaid start and end points");
+
+		return {data() + Start, end - Start};
+	}
+
+	template<typename T, size_t Align>
+	template<size_t Start> auto AlignedArrayPtr<T, Align>::aligned_slice() -> AlignedArrayPtr<T, hidden::offset_alignment(Align, Start * sizeof(T))>
+	{
+		return aligned_slice<Start>(ArrayPtr<T>::size());
+	}
+
+	template<typename T, size_t Align> AlignedArrayPtr<T, Align> AlignedArrayPtr<T, Align>::aligned_slice(size_t start, size_t end)
+	{
+		RCOM_ASSERT(end <= ArrayPtr<T>::size(),             "Index out of range");
+		RCOM_ASSERT(start < end,                            "Invaid start and end points");
+		RCOM_ASSERT(::byte_size<T>(start) % Align == 0,     "Slice start is not aligned");
+
+		return {data() + start, end - start};
+	}
+
+	template<typename T, size_t Align> T* AlignedArrayPtr<T, Align>::data()
+	{
+		return hidden::assume_aligned<Align>(ArrayPtr<T>::data());
+	}
+
+	template<typename T, size_t Align> const T* AlignedArrayPtr<T, Align>::data() const
+	{
+		return hidden::assume_aligned<Align>(ArrayPtr<T>::data());
+	}
+
+	template<typename T, size_t Align> T* AlignedArrayPtr<T, Align>::begin()
+	{
+		return data();
+	}
+
+	template<typename T, size_t Align> const T* AlignedArrayPtr<T, Align>::begin() const
+	{
+		return data();
+	}
+
+	template<typename T, size_t Align> T* AlignedArrayPtr<T, Align>::end()
+	{
+		return data() + ArrayPtr<T>::size();
+	}
+
+	template<typename T, size_t Align> const T* AlignedArrayPtr<T, Align>::end() const
+	{
+		return data() + ArrayPtr<T>::size();
+	}
+
+	template<typename T, size_t N, size_t Align> AlignedArrayPtr<T, Align> AlignedArray<T, N, Align>::to_aligned_ptr()
+	{
+		return {this->data(), N};
+	}
+
+	template<typename T, size_t N, size_t Align> const AlignedArrayPtr<const T, Align> AlignedArray<T, N, Align>::to_aligned_ptr() const
+	{
+		return {this->data(), N};
+	}
+}
+// namespace::rcom
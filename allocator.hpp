@@ -0,0 +1,150 @@
+#pragma once
+
+// Allocator hooks used by the owning containers
+//
+// An allocator is any copyable object with the following members:
+//   BytePtr allocate(size_t size, size_t align);
+//   BytePtr reallocate(BytePtr ptr, size_t size, size_t align);
+//   void    deallocate(BytePtr ptr, size_t align);
+//
+// Allocation failure is reported by returning a null BytePtr.
+// reallocate preserves the bytes of ptr and leaves ptr untouched if it fails.
+
+#include "array_ptr.hpp"
+#include <new>
+#include <utility>
+#include <type_traits>
+
+namespace rcom
+{
+	// Forwards to malloc/realloc/free
+	struct MallocAllocator
+	{
+		inline BytePtr allocate(size_t size, size_t align);
+		inline BytePtr reallocate(BytePtr ptr, size_t size, size_t align);
+		inline void    deallocate(BytePtr ptr, size_t align);
+	};
+
+	BytePtr MallocAllocator::allocate(size_t size, size_t align)
+	{
+		RCOM_ASSERT(size > 0, "Zero sized allocation");
+		RCOM_ASSERT((align & (align - 1)) == 0, "Alignment must be a power of two");
+
+		void* mem = nullptr;
+
+		if(align <= alignof(std::max_align_t))
+		{
+			mem = malloc(size);
+		}
+		else
+		{
+#if defined(_MSC_VER)
+			mem = _aligned_malloc(size, align);
+#else
+			if(posix_memalign(&mem, align, size) != 0)
+			{
+				mem = nullptr;
+			}
+#endif
+		}
+
+		return {static_cast<uint8_t*>(mem), mem ? size : 0};
+	}
+
+	BytePtr MallocAllocator::reallocate(BytePtr ptr, size_t size, size_t align)
+	{
+		if(!ptr)
+		{
+			return allocate(size, align);
+		}
+
+		if(align <= alignof(std::max_align_t))
+		{
+			void* mem = realloc(ptr.data(), size);
+			return {static_cast<uint8_t*>(mem), mem ? size : 0};
+		}
+
+		// No aligned realloc, copy by hand
+		BytePtr mem = allocate(size, align);
+
+		if(mem)
+		{
+			memcpy(mem.data(), ptr.data(), ptr.size() < size ? ptr.size() : size);
+			deallocate(ptr, align);
+		}
+		return mem;
+	}
+
+	void MallocAllocator::deallocate(BytePtr ptr, size_t align)
+	{
+#if defined(_MSC_VER)
+		if(align > alignof(std::max_align_t))
+		{
+			_aligned_free(ptr.data());
+			return;
+		}
+#else
+		(void)align;
+#endif
+		free(ptr.data());
+	}
+
+	// Types which can be moved to a new address with memcpy and without calling the destructor on the old address.
+	// Specialise for your own types that are safe to relocate but not trivially copyable
+	template<typename T> struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+	// Allocate an array of count T. Elements are not constructed
+	template<typename T, typename Alloc> inline ArrayPtr<T> allocate_array(Alloc& alloc, size_t count)
+	{
+		BytePtr mem = alloc.allocate(::byte_size<T>(count), alignof(T));
+		return {reinterpret_cast<T*>(mem.data()), mem ? count : 0};
+	}
+
+	// Free an array obtained from allocate_array. Elements are not destroyed
+	template<typename T, typename Alloc> inline void deallocate_array(Alloc& alloc, ArrayPtr<T> ptr)
+	{
+		if(ptr)
+		{
+			alloc.deallocate(ptr.to_bytes(), alignof(T));
+		}
+	}
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	// Move count objects from src into uninitialized dst, leaving src uninitialized
+	template<typename T> inline void relocate(T* dst, T* src, size_t count, std::true_type)
+	{
+		if(count)
+		{
+			memcpy(static_cast<void*>(dst), static_cast<const void*>(src), ::byte_size<T>(count));
+		}
+	}
+
+	template<typename T> inline void relocate(T* dst, T* src, size_t count, std::false_type)
+	{
+		for(size_t i = 0; i < count; ++i)
+		{
+			new(&dst[i]) T(std::move(src[i]));
+			src[i].~T();
+		}
+	}
+
+	template<typename T> inline void relocate(T* dst, T* src, size_t count)
+	{
+		relocate(dst, src, count, std::integral_constant<bool, is_trivially_relocatable<T>::value>{});
+	}
+
+	template<typename T> inline void destroy(T* ptr, size_t count)
+	{
+		if(!std::is_trivially_destructible<T>::value)
+		{
+			for(size_t i = 0; i < count; ++i)
+			{
+				ptr[i].~T();
+			}
+		}
+	}
+}}
+// namespace rcom::hidden
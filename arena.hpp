@@ -0,0 +1,202 @@
+#pragma once
+
+// Linear (bump) allocator over a caller provided region of memory
+
+#include "allocator.hpp"
+
+namespace rcom
+{
+	// Position in an arena to rewind to
+	struct ArenaMark
+	{
+		size_t offset;
+	};
+
+	class Arena
+	{
+	public:
+		inline Arena();
+		inline explicit Arena(BytePtr region);
+
+		// Return nullptr if the arena is out of space
+		inline BytePtr allocate_bytes(size_t size, size_t align = alignof(std::max_align_t));
+		template<typename T>
+		inline ArrayPtr<T> allocate(size_t count);
+
+		// Try to resize the most recent allocation in place
+		inline bool resize_last(BytePtr ptr, size_t size);
+		// Give back the most recent allocation. Does nothing for any other allocation
+		inline void free_last(BytePtr ptr);
+
+		inline ArenaMark mark() const;
+		inline void      rewind(ArenaMark m);
+		inline void      reset();
+
+		inline size_t used()      const;
+		inline size_t remaining() const;
+		inline size_t capacity()  const;
+
+		inline       BytePtr to_bytes();
+		inline const BytePtr to_bytes() const;
+	private:
+		BytePtr region;
+		size_t  offset;
+
+		inline bool is_last(BytePtr ptr) const;
+	};
+
+	// Allocator hook for containers. Memory is only released when the arena is rewound or reset
+	struct ArenaAllocator
+	{
+		Arena* arena;
+
+		inline BytePtr allocate(size_t size, size_t align);
+		inline BytePtr reallocate(BytePtr ptr, size_t size, size_t align);
+		inline void    deallocate(BytePtr ptr, size_t align);
+	};
+
+	Arena::Arena() :
+		region{},
+		offset{0}
+	{
+	}
+
+	Arena::Arena(BytePtr r) :
+		region{r},
+		offset{0}
+	{
+	}
+
+	BytePtr Arena::allocate_bytes(size_t size, size_t align)
+	{
+		RCOM_ASSERT(size > 0, "Zero sized allocation");
+		RCOM_ASSERT((align & (align - 1)) == 0, "Alignment must be a power of two");
+
+		uintptr_t base  = reinterpret_cast<uintptr_t>(region.data());
+		uintptr_t start = (base + offset + align - 1) & ~uintptr_t(align - 1);
+		size_t    begin = start - base;
+
+		if(begin > region.size() || size > region.size() - begin)
+		{
+			return nullptr;
+		}
+
+		offset = begin + size;
+		return {region.data() + begin, size};
+	}
+
+	template<typename T> ArrayPtr<T> Arena::allocate(size_t count)
+	{
+		BytePtr mem = allocate_bytes(::byte_size<T>(count), alignof(T));
+		return {reinterpret_cast<T*>(mem.data()), mem ? count : 0};
+	}
+
+	bool Arena::is_last(BytePtr ptr) const
+	{
+		return ptr && ptr.data() + ptr.size() == region.data() + offset;
+	}
+
+	bool Arena::resize_last(BytePtr ptr, size_t size)
+	{
+		if(!is_last(ptr))
+		{
+			return false;
+		}
+
+		size_t begin = ptr.data() - region.data();
+
+		if(size > region.size() - begin)
+		{
+			return false;
+		}
+
+		offset = begin + size;
+		return true;
+	}
+
+	void Arena::free_last(BytePtr ptr)
+	{
+		if(is_last(ptr))
+		{
+			offset = ptr.data() - region.data();
+		}
+	}
+
+	ArenaMark Arena::mark() const
+	{
+		return {offset};
+	}
+
+	void Arena::rewind(ArenaMark m)
+	{
+		RCOM_ASSERT(m.offset <= region.size(), "Arena mark out of range");
+		offset = m.offset;
+	}
+
+	void Arena::reset()
+	{
+		offset = 0;
+	}
+
+	size_t Arena::used() const
+	{
+		return offset;
+	}
+
+	size_t Arena::remaining() const
+	{
+		return region.size() - offset;
+	}
+
+	size_t Arena::capacity() const
+	{
+		return region.size();
+	}
+
+	BytePtr Arena::to_bytes()
+	{
+		return region;
+	}
+
+	const BytePtr Arena::to_bytes() const
+	{
+		return region;
+	}
+
+	BytePtr ArenaAllocator::allocate(size_t size, size_t align)
+	{
+		RCOM_ASSERT(arena, "Null pointer");
+		return arena->allocate_bytes(size, align);
+	}
+
+	BytePtr ArenaAllocator::reallocate(BytePtr ptr, size_t size, size_t align)
+	{
+		RCOM_ASSERT(arena, "Null pointer");
+
+		// Growing the newest allocation is free
+		if(arena->resize_last(ptr, size))
+		{
+			return {ptr.data(), size};
+		}
+
+		BytePtr mem = arena->allocate_bytes(size, align);
+
+		if(mem && ptr)
+		{
+			memcpy(mem.data(), ptr.data(), ptr.size() < size ? ptr.size() : size);
+		}
+		return mem;
+	}
+
+	void ArenaAllocator::deallocate(BytePtr ptr, size_t)
+	{
+		RCOM_ASSERT(arena, "Null pointer");
+		arena->free_last(ptr);
+	}
+}
+// namespace::rcom
+
+// Rewind the arena to its current position at the end of scope
+#define RCOM_ARENA_SCOPE(ARENA)                                                 \
+	const rcom::ArenaMark RCOM_CONCAT(zz_arena_mark, __LINE__) = (ARENA).mark(); \
+	RCOM_DEFER_TO_SCOPE{(ARENA).rewind(RCOM_CONCAT(zz_arena_mark, __LINE__));}
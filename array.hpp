@@ -35,54 +35,54 @@ namespace rcom
 		inline static constexpr size_t byte_size();
 		inline static constexpr size_t flat_size();
 
-		inline       ArrayPtr<T> to_ptr();
-		inline const ArrayPtr<T> to_ptr() const;
-		inline       ArrayPtr<T> to_flat();
-		inline const ArrayPtr<T> to_flat() const;
-		inline       BytePtr     to_bytes();
-		inline const BytePtr     to_bytes() const;
-
-		inline const ArrayPtr<T> slice(size_t start, size_t end) const;
-		inline       ArrayPtr<T> slice(size_t start, size_t end);
-		inline const ArrayPtr<T> slice(size_t start) const;
-		inline       ArrayPtr<T> slice(size_t start);
-
-		inline const BytePtr byte_slice(size_t start, size_t end) const;
-		inline       BytePtr byte_slice(size_t start, size_t end);
-		inline const BytePtr byte_slice(size_t start) const;
-		inline       BytePtr byte_slice(size_t start);
+		inline constexpr ArrayPtr<T>             to_ptr();
+		inline constexpr ArrayPtr<const T>       to_ptr() const;
+		inline constexpr ArrayPtr<T>             to_flat();
+		inline constexpr ArrayPtr<const T>       to_flat() const;
+		inline           BytePtr                 to_bytes();
+		inline           ArrayPtr<const uint8_t> to_bytes() const;
+
+		inline constexpr ArrayPtr<const T> slice(size_t start, size_t end) const;
+		inline constexpr ArrayPtr<T>       slice(size_t start, size_t end);
+		inline constexpr ArrayPtr<const T> slice(size_t start) const;
+		inline constexpr ArrayPtr<T>       slice(size_t start);
+
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start, size_t end) const;
+		inline BytePtr                 byte_slice(size_t start, size_t end);
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start) const;
+		inline BytePtr                 byte_slice(size_t start);
 
 		inline constexpr       T& operator[](size_t i);
 		inline constexpr const T& operator[](size_t i) const;
 
-		inline       T* data();
-		inline const T* data()   const;
-		inline       T* begin();
-		inline const T* begin()  const;
-		inline       T* end();
-		inline const T* end()    const;
-		inline       T& first();
-		inline const T& first()  const;
-		inline       T& last();
-		inline const T& last()   const;
+		inline constexpr       T* data();
+		inline constexpr const T* data()   const;
+		inline constexpr       T* begin();
+		inline constexpr const T* begin()  const;
+		inline constexpr       T* end();
+		inline constexpr const T* end()    const;
+		inline constexpr       T& first();
+		inline constexpr const T& first()  const;
+		inline constexpr       T& last();
+		inline constexpr const T& last()   const;
 	};
 
-	template<typename T, size_t N> ArrayPtr<T> Array<T, N>::to_ptr()
+	template<typename T, size_t N> constexpr ArrayPtr<T> Array<T, N>::to_ptr()
 	{
 		return {_arr, N};
 	}
 
-	template<typename T, size_t N> const ArrayPtr<T> Array<T, N>::to_ptr() const
+	template<typename T, size_t N> constexpr ArrayPtr<const T> Array<T, N>::to_ptr() const
 	{
 		return {_arr, N};
 	}
 
-	template<typename T, size_t N> ArrayPtr<T> Array<T, N>::to_flat()
+	template<typename T, size_t N> constexpr ArrayPtr<T> Array<T, N>::to_flat()
 	{
 		return {_arr, _flat_size};
 	}
 
-	template<typename T, size_t N> const ArrayPtr<T> Array<T, N>::to_flat() const
+	template<typename T, size_t N> constexpr ArrayPtr<const T> Array<T, N>::to_flat() const
 	{
 		return {_arr, _flat_size};
 	}
@@ -92,17 +92,22 @@ namespace rcom
 		return _byte_size;
 	}
 
+	template<typename T, size_t N> constexpr size_t Array<T, N>::flat_size()
+	{
+		return _flat_size;
+	}
+
 	template<typename T, size_t N> BytePtr Array<T, N>::to_bytes()
 	{
 		return {reinterpret_cast<uint8_t*>(_arr), _byte_size};
 	}
 
-	template<typename T, size_t N> const BytePtr Array<T, N>::to_bytes() const
+	template<typename T, size_t N> ArrayPtr<const uint8_t> Array<T, N>::to_bytes() const
 	{
-		return {reinterpret_cast<uint8_t*>(_arr), _byte_size};
+		return {reinterpret_cast<const uint8_t*>(_arr), _byte_size};
 	}
 
-	template<typename T, size_t N> const ArrayPtr<T> Array<T, N>::slice(size_t start, size_t end) const
+	template<typename T, size_t N> constexpr ArrayPtr<const T> Array<T, N>::slice(size_t start, size_t end) const
 	{
 		RCOM_ASSERT(start  >= 0,   "Index out of range");
 		RCOM_ASSERT(end    <= N,   "Index out of range");
@@ -111,7 +116,7 @@ namespace rcom
 		return {&_arr[start], end - start};
 	}
 
-	template<typename T, size_t N> ArrayPtr<T> Array<T, N>::slice(size_t start, size_t end)
+	template<typename T, size_t N> constexpr ArrayPtr<T> Array<T, N>::slice(size_t start, size_t end)
 	{
 		RCOM_ASSERT(start  >= 0,   "Index out of range");
 		RCOM_ASSERT(end    <= N,   "Index out of range");
@@ -120,23 +125,23 @@ namespace rcom
 		return {&_arr[start], end - start};
 	}
 
-	template<typename T, size_t N> ArrayPtr<T> Array<T, N>::slice(size_t start)
+	template<typename T, size_t N> constexpr ArrayPtr<T> Array<T, N>::slice(size_t start)
 	{
 		return slice(start, N);
 	}
 
-	template<typename T, size_t N> ArrayPtr<T> const Array<T, N>::slice(size_t start) const
+	template<typename T, size_t N> constexpr ArrayPtr<const T> Array<T, N>::slice(size_t start) const
 	{
 		return slice(start, N);
 	}
 
-	template<typename T, size_t N> const BytePtr Array<T, N>::byte_slice(size_t start, size_t end) const
+	template<typename T, size_t N> ArrayPtr<const uint8_t> Array<T, N>::byte_slice(size_t start, size_t end) const
 	{
 		RCOM_ASSERT(start  >= 0,   "Index out of range");
 		RCOM_ASSERT(end    <= N,   "Index out of range");
 		RCOM_ASSERT(start  <  end, "Invaid start and end points");
 
-		return {reinterpret_cast<uint8_t*>(&_arr[start]), ::byte_size<T>(end - start)};
+		return {reinterpret_cast<const uint8_t*>(&_arr[start]), ::byte_size<T>(end - start)};
 	}
 
 	template<typename T, size_t N> BytePtr Array<T, N>::byte_slice(size_t start, size_t end)
@@ -148,7 +153,7 @@ namespace rcom
 		return {reinterpret_cast<uint8_t*>(&_arr[start]), ::byte_size<T>(end - start)};
 	}
 
-	template<typename T, size_t N> const BytePtr Array<T, N>::byte_slice(size_t start) const
+	template<typename T, size_t N> ArrayPtr<const uint8_t> Array<T, N>::byte_slice(size_t start) const
 	{
 		return byte_slice(start, N);
 	}
@@ -170,60 +175,64 @@ namespace rcom
 		return _arr[i];
 	}
 	
-	template<typename T, size_t N> T* Array<T, N>::begin()
+	template<typename T, size_t N> constexpr T* Array<T, N>::begin()
 	{
 		return &_arr[0];
 	}
 	
-	template<typename T, size_t N> const T* Array<T, N>::begin() const
+	template<typename T, size_t N> constexpr const T* Array<T, N>::begin() const
 	{
 		return &_arr[0];
 	}
 	
-	template<typename T, size_t N> T* Array<T, N>::end()
+	template<typename T, size_t N> constexpr T* Array<T, N>::end()
 	{
 		return &_arr[N];
 	}
 	
-	template<typename T, size_t N> const T* Array<T, N>::end() const
+	template<typename T, size_t N> constexpr const T* Array<T, N>::end() const
 	{
 		return &_arr[N];
 	}
 	
-	template<typename T, size_t N> const T* Array<T, N>::data() const
+	template<typename T, size_t N> constexpr const T* Array<T, N>::data() const
 	{
 		return &_arr[0];
 	}
 	
-	template<typename T, size_t N> T* Array<T, N>::data()
+	template<typename T, size_t N> constexpr T* Array<T, N>::data()
 	{
 		return &_arr[0];
 	}
 
-	template<typename T, size_t N> T& Array<T, N>::first()
+	template<typename T, size_t N> constexpr T& Array<T, N>::first()
 	{
 		return _arr[0];
 	}
 
-	template<typename T, size_t N> const T& Array<T, N>::first() const
+	template<typename T, size_t N> constexpr const T& Array<T, N>::first() const
 	{
 		return _arr[0];
 	}
 
-	template<typename T, size_t N> T& Array<T, N>::last()
+	template<typename T, size_t N> constexpr T& Array<T, N>::last()
 	{
 		return _arr[N-1];
 	}
 
-	template<typename T, size_t N> const T& Array<T, N>::last() const
+	template<typename T, size_t N> constexpr const T& Array<T, N>::last() const
 	{
 		return _arr[N-1];
 	}
 
+	// Definitions for the static members, needed when they are odr-used before C++17
+	template<typename T, size_t N> constexpr const size_t Array<T, N>::_flat_size;
+	template<typename T, size_t N> constexpr const size_t Array<T, N>::_byte_size;
+
 	template<typename T, size_t N>
 	template<size_t NN> constexpr size_t Array<T, N>::size()
 	{
-		static_assert(NN < N, "Multidimensional array index out of range");
+		static_assert(NN == 0, "Multidimensional array index out of range");
 		return N;
 	}
 
@@ -258,44 +267,44 @@ namespace rcom
 		inline static constexpr size_t byte_size();
 		inline static constexpr size_t flat_size();
 
-		inline       ArrayPtr<ArrayType> to_ptr();
-		inline const ArrayPtr<ArrayType> to_ptr() const;
-		inline       ArrayPtr<T>         to_flat();
-		inline const ArrayPtr<T>         to_flat() const;
-		inline       BytePtr             to_bytes();
-		inline const BytePtr             to_bytes() const;
+		inline constexpr ArrayPtr<ArrayType>       to_ptr();
+		inline constexpr ArrayPtr<const ArrayType> to_ptr() const;
+		inline           ArrayPtr<T>               to_flat();
+		inline           ArrayPtr<const T>         to_flat() const;
+		inline           BytePtr                   to_bytes();
+		inline           ArrayPtr<const uint8_t>   to_bytes() const;
 
-		inline const ArrayPtr<ArrayType> slice(size_t start, size_t end) const;
-		inline       ArrayPtr<ArrayType> slice(size_t start, size_t end);
-		inline const ArrayPtr<ArrayType> slice(size_t start) const;
-		inline       ArrayPtr<ArrayType> slice(size_t start);
+		inline constexpr ArrayPtr<const ArrayType> slice(size_t start, size_t end) const;
+		inline constexpr ArrayPtr<ArrayType>       slice(size_t start, size_t end);
+		inline constexpr ArrayPtr<const ArrayType> slice(size_t start) const;
+		inline constexpr ArrayPtr<ArrayType>       slice(size_t start);
 
-		inline const BytePtr byte_slice(size_t start, size_t end) const;
-		inline       BytePtr byte_slice(size_t start, size_t end);
-		inline const BytePtr byte_slice(size_t start) const;
-		inline       BytePtr byte_slice(size_t start);
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start, size_t end) const;
+		inline BytePtr                 byte_slice(size_t start, size_t end);
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start) const;
+		inline BytePtr                 byte_slice(size_t start);
 
 		inline constexpr       ArrayType& operator[](size_t i);
 		inline constexpr const ArrayType& operator[](size_t i)  const;
 
-		inline       ArrayType* data();
-		inline const ArrayType* data()   const;
-		inline       ArrayType* begin();
-		inline const ArrayType* begin()  const;
-		inline       ArrayType* end();
-		inline const ArrayType* end()    const;
-		inline       ArrayType& first();
-		inline const ArrayType& first()  const;
-		inline       ArrayType& last();
-		inline const ArrayType& last()   const;
+		inline constexpr       ArrayType* data();
+		inline constexpr const ArrayType* data()   const;
+		inline constexpr       ArrayType* begin();
+		inline constexpr const ArrayType* begin()  const;
+		inline constexpr       ArrayType* end();
+		inline constexpr const ArrayType* end()    const;
+		inline constexpr       ArrayType& first();
+		inline constexpr const ArrayType& first()  const;
+		inline constexpr       ArrayType& last();
+		inline constexpr const ArrayType& last()   const;
 	};
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::to_ptr() -> ArrayPtr<ArrayType>
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::to_ptr() -> ArrayPtr<ArrayType>
 	{
 		return {_arr, N};
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::to_ptr() const -> const ArrayPtr<ArrayType>
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::to_ptr() const -> ArrayPtr<const ArrayType>
 	{
 		return {_arr, N};
 	}
@@ -305,58 +314,58 @@ namespace rcom
 		return {reinterpret_cast<uint8_t*>(_arr), _byte_size};
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::to_bytes() const -> const BytePtr
+	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::to_bytes() const -> ArrayPtr<const uint8_t>
 	{
-		return {reinterpret_cast<uint8_t*>(_arr), _byte_size};
+		return {reinterpret_cast<const uint8_t*>(_arr), _byte_size};
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::slice(size_t start, size_t end) const -> const ArrayPtr<ArrayType>
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::slice(size_t start, size_t end) const -> ArrayPtr<const ArrayType>
 	{
 		RCOM_ASSERT(start   >= 0,     "Index out of range");
-		RCOM_ASSERT(end     <= _size, "Index out of range");
+		RCOM_ASSERT(end     <= N,     "Index out of range");
 		RCOM_ASSERT(start   <  end,   "Invaid start and end points");
 
 		return {&_arr[start], end - start};
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::slice(size_t start, size_t end) -> ArrayPtr<ArrayType>
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::slice(size_t start, size_t end) -> ArrayPtr<ArrayType>
 	{
 		RCOM_ASSERT(start   >= 0,     "Index out of range");
-		RCOM_ASSERT(end     <= _size, "Index out of range");
+		RCOM_ASSERT(end     <= N,     "Index out of range");
 		RCOM_ASSERT(start   <  end,   "Invaid start and end points");
 
 		return {&_arr[start], end - start};
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::slice(size_t start) const -> const ArrayPtr<ArrayType>
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::slice(size_t start) const -> ArrayPtr<const ArrayType>
 	{
 		return slice(start, N);
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::slice(size_t start) -> ArrayPtr<ArrayType>
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::slice(size_t start) -> ArrayPtr<ArrayType>
 	{
 		return slice(start, N);
 	}
 
-	template<typename T, size_t N, size_t... NS> const BytePtr Array<T, N, NS...>::byte_slice(size_t start, size_t end) const
+	template<typename T, size_t N, size_t... NS> ArrayPtr<const uint8_t> Array<T, N, NS...>::byte_slice(size_t start, size_t end) const
 	{
 		RCOM_ASSERT(start  >= 0,     "Index out of range");
-		RCOM_ASSERT(end    <= _size, "Index out of range");
+		RCOM_ASSERT(end    <= N,     "Index out of range");
 		RCOM_ASSERT(start  <  end,   "Invaid start and end points");
 
-		return {reinterpret_cast<uint8_t*>(&_arr[start]), ::byte_size<ArrayType>(end - start)};
+		return {reinterpret_cast<const uint8_t*>(&_arr[start]), ::byte_size<ArrayType>(end - start)};
 	}
 
 	template<typename T, size_t N, size_t... NS> BytePtr Array<T, N, NS...>::byte_slice(size_t start, size_t end)
 	{
 		RCOM_ASSERT(start  >= 0,     "Index out of range");
-		RCOM_ASSERT(end    <= _size, "Index out of range");
+		RCOM_ASSERT(end    <= N,     "Index out of range");
 		RCOM_ASSERT(start  <  end,   "Invaid start and end points");
 
 		return {reinterpret_cast<uint8_t*>(&_arr[start]), ::byte_size<ArrayType>(end - start)};
 	}
 
-	template<typename T, size_t N, size_t... NS> const BytePtr Array<T, N, NS...>::byte_slice(size_t start) const
+	template<typename T, size_t N, size_t... NS> ArrayPtr<const uint8_t> Array<T, N, NS...>::byte_slice(size_t start) const
 	{
 		return byte_slice(start, N);
 	}
@@ -378,42 +387,52 @@ namespace rcom
 		return _arr[i];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::begin() -> ArrayType*
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::begin() -> ArrayType*
 	{
 		return &_arr[0];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::begin() const -> const ArrayType*
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::begin() const -> const ArrayType*
 	{
 		return &_arr[0];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::end() -> ArrayType*
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::end() -> ArrayType*
 	{
 		return &_arr[N];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::end() const -> const ArrayType*
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::end() const -> const ArrayType*
 	{
 		return &_arr[N];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::first() -> ArrayType&
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::data() -> ArrayType*
 	{
-		return _arr[N];
+		return &_arr[0];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::first() const -> const ArrayType&
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::data() const -> const ArrayType*
 	{
-		return _arr[N];
+		return &_arr[0];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::last() -> ArrayType&
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::first() -> ArrayType&
+	{
+		return _arr[0];
+	}
+
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::first() const -> const ArrayType&
+	{
+		return _arr[0];
+	}
+
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::last() -> ArrayType&
 	{
 		return _arr[N-1];
 	}
 
-	template<typename T, size_t N, size_t... NS> auto Array<T, N, NS...>::last() const -> const ArrayType&
+	template<typename T, size_t N, size_t... NS> constexpr auto Array<T, N, NS...>::last() const -> const ArrayType&
 	{
 		return _arr[N-1];
 	}
@@ -421,7 +440,7 @@ namespace rcom
 	template<typename T, size_t N, size_t... NS>
 	template<size_t NN> constexpr size_t Array<T, N, NS...>::size()
 	{
-		static_assert(NN < N, "Multidimensional array index out of range");
+		static_assert(NN < 1 + sizeof...(NS), "Multidimensional array index out of range");
 		return _sizes[NN];
 	}
 
@@ -440,9 +459,26 @@ namespace rcom
 		return {reinterpret_cast<T*>(_arr), _flat_size};
 	}
 
-	template<typename T, size_t N, size_t... NS> const ArrayPtr<T> Array<T, N, NS...>::to_flat() const
+	template<typename T, size_t N, size_t... NS> ArrayPtr<const T> Array<T, N, NS...>::to_flat() const
 	{
-		return {reinterpret_cast<T*>(_arr), _flat_size};
+		return {reinterpret_cast<const T*>(_arr), _flat_size};
+	}
+
+	template<typename T, size_t N, size_t... NS> constexpr const Array<size_t, 1 + sizeof...(NS)> Array<T, N, NS...>::_sizes;
+	template<typename T, size_t N, size_t... NS> constexpr const size_t Array<T, N, NS...>::_flat_size;
+	template<typename T, size_t N, size_t... NS> constexpr const size_t Array<T, N, NS...>::_byte_size;
+
+	// Build an Array with arr[i] = func(i). Usable in constant expressions to bake tables into read only data
+	// C++14 lambdas are not constexpr, so pass a function object with a constexpr operator()
+	template<typename T, size_t N, typename Func> inline constexpr Array<T, N> generate_array(Func func)
+	{
+		Array<T, N> arr{};
+
+		for(size_t i = 0; i < N; ++i)
+		{
+			arr[i] = func(i);
+		}
+		return arr;
 	}
 }
 // namespace::rcom
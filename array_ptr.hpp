@@ -1,6 +1,8 @@
 #pragma once
 
 #include "basic.hpp"
+#include "simd_search.hpp"
+#include "simd_memory.hpp"
 #include <cstring>
 
 namespace rcom
@@ -11,90 +13,90 @@ namespace rcom
 	template<typename T> class ArrayPtr
 	{
 	public:
-		inline ArrayPtr();
-		inline ArrayPtr(std::nullptr_t);
-		inline ArrayPtr(T* t, size_t n);
-		template<size_t N> inline ArrayPtr(T(&t)[N]);
+		inline constexpr ArrayPtr();
+		inline constexpr ArrayPtr(std::nullptr_t);
+		inline constexpr ArrayPtr(T* t, size_t n);
+		template<size_t N> inline constexpr ArrayPtr(T(&t)[N]);
 	
-		inline operator ArrayPtr<const T>() const;
-		inline operator bool()              const;
+		inline constexpr operator ArrayPtr<const T>() const;
+		inline constexpr operator bool()              const;
 
-		inline size_t& size();
-		inline size_t  size()      const;
-		inline size_t  byte_size() const;
+		inline constexpr size_t& size();
+		inline constexpr size_t  size()      const;
+		inline constexpr size_t  byte_size() const;
 
 		inline       BytePtr to_bytes();
 		inline const BytePtr to_bytes() const;
 	
-		inline const ArrayPtr<T> slice(size_t start, size_t end) const;
-		inline       ArrayPtr<T> slice(size_t start, size_t end);
-		inline const ArrayPtr<T> slice(size_t start) const;
-		inline       ArrayPtr<T> slice(size_t start);
+		inline constexpr const ArrayPtr<T> slice(size_t start, size_t end) const;
+		inline constexpr       ArrayPtr<T> slice(size_t start, size_t end);
+		inline constexpr const ArrayPtr<T> slice(size_t start) const;
+		inline constexpr       ArrayPtr<T> slice(size_t start);
 
 		inline const BytePtr byte_slice(size_t start, size_t end) const;
 		inline       BytePtr byte_slice(size_t start, size_t end);
 		inline const BytePtr byte_slice(size_t start) const;
 		inline       BytePtr byte_slice(size_t start);
 
-		inline       T&  operator[](size_t i);
-		inline const T&  operator[](size_t i)  const;
+		inline constexpr       T&  operator[](size_t i);
+		inline constexpr const T&  operator[](size_t i)  const;
 
-		inline       T*  begin();
-		inline const T*  begin() const;
-		inline       T*  end();
-		inline const T*  end()   const;
-		inline       T&  first();
-		inline const T&  first() const;
-		inline       T&  last();
-		inline const T&  last()  const;
+		inline constexpr       T*  begin();
+		inline constexpr const T*  begin() const;
+		inline constexpr       T*  end();
+		inline constexpr const T*  end()   const;
+		inline constexpr       T&  first();
+		inline constexpr const T&  first() const;
+		inline constexpr       T&  last();
+		inline constexpr const T&  last()  const;
 
-		inline       T*& data();
-		inline const T*  data()  const;
+		inline constexpr       T*& data();
+		inline constexpr const T*  data()  const;
 	private:
 		T*     ptr;
 		size_t len;
 	};
 	
-	template<typename T> ArrayPtr<T>::ArrayPtr() :
+	template<typename T> constexpr ArrayPtr<T>::ArrayPtr() :
 		ptr{nullptr},
 		len{0}
 	{
 	}
 	
-	template<typename T> ArrayPtr<T>::ArrayPtr(std::nullptr_t) :
+	template<typename T> constexpr ArrayPtr<T>::ArrayPtr(std::nullptr_t) :
 		ArrayPtr{}
 	{
 	}
 	
-	template<typename T> ArrayPtr<T>::ArrayPtr(T* t, size_t n) :
+	template<typename T> constexpr ArrayPtr<T>::ArrayPtr(T* t, size_t n) :
 		ptr{t},
 		len{n}
 	{
 	}
 	
-	template<typename T> template<size_t N> inline ArrayPtr<T>::ArrayPtr(T(&t)[N]) :
+	template<typename T> template<size_t N> constexpr ArrayPtr<T>::ArrayPtr(T(&t)[N]) :
 		ArrayPtr{t, N}
 	{
 	}
 	
-	template<typename T> ArrayPtr<T>::operator ArrayPtr<const T>() const
+	template<typename T> constexpr ArrayPtr<T>::operator ArrayPtr<const T>() const
 	{
 		return {ptr, len};
 	}
 	
-	template<typename T> T& ArrayPtr<T>::operator[](size_t i)
+	template<typename T> constexpr T& ArrayPtr<T>::operator[](size_t i)
 	{
 		RCOM_ASSERT(i < len, "Index out of range");
 		return ptr[i];
 	}
 	
-	template<typename T> const T& ArrayPtr<T>::operator[](size_t i) const
+	template<typename T> constexpr const T& ArrayPtr<T>::operator[](size_t i) const
 	{
 		RCOM_ASSERT(i < len, "Index out of range");
 		return ptr[i];
 	}
 
-	template<typename T> const ArrayPtr<T> ArrayPtr<T>::slice(size_t start, size_t end) const
+	template<typename T> constexpr const ArrayPtr<T> ArrayPtr<T>::slice(size_t start, size_t end) const
 	{
 		RCOM_ASSERT(len    >  0,   "Index out of range");
 		RCOM_ASSERT(start  >= 0,   "Index out of range");
@@ -104,7 +106,7 @@ namespace rcom
 		return {&ptr[start], end - start};
 	}
 
-	template<typename T> ArrayPtr<T> ArrayPtr<T>::slice(size_t start, size_t end)
+	template<typename T> constexpr ArrayPtr<T> ArrayPtr<T>::slice(size_t start, size_t end)
 	{
 		RCOM_ASSERT(len    >  0,   "Index out of range");
 		RCOM_ASSERT(start  >= 0,   "Index out of range");
@@ -114,12 +116,12 @@ namespace rcom
 		return {&ptr[start], end - start};
 	}
 
-	template<typename T> ArrayPtr<T> ArrayPtr<T>::slice(size_t start)
+	template<typename T> constexpr ArrayPtr<T> ArrayPtr<T>::slice(size_t start)
 	{
 		return slice(start, len);
 	}
 
-	template<typename T> ArrayPtr<T> const ArrayPtr<T>::slice(size_t start) const
+	template<typename T> constexpr ArrayPtr<T> const ArrayPtr<T>::slice(size_t start) const
 	{
 		return slice(start, len);
 	}
@@ -154,76 +156,76 @@ namespace rcom
 		return byte_slice(start, len);
 	}
 
-	template<typename T> T& ArrayPtr<T>::first()
+	template<typename T> constexpr T& ArrayPtr<T>::first()
 	{
 		RCOM_ASSERT(len > 0, "Index out of range");
 		return ptr[0];
 	}
 
-	template<typename T> const T& ArrayPtr<T>::first() const
+	template<typename T> constexpr const T& ArrayPtr<T>::first() const
 	{
 		RCOM_ASSERT(len > 0, "Index out of range");
 		return ptr[0];
 	}
 
-	template<typename T> T& ArrayPtr<T>::last()
+	template<typename T> constexpr T& ArrayPtr<T>::last()
 	{
 		RCOM_ASSERT(len > 0, "Index out of range");
 		return ptr[len - 1];
 	}
 
-	template<typename T> const T& ArrayPtr<T>::last() const
+	template<typename T> constexpr const T& ArrayPtr<T>::last() const
 	{
 		RCOM_ASSERT(len > 0, "Index out of range");
 		return ptr[len - 1];
 	}
 	
-	template<typename T> T* ArrayPtr<T>::begin()
+	template<typename T> constexpr T* ArrayPtr<T>::begin()
 	{
 		return ptr;
 	}
 	
-	template<typename T> const T* ArrayPtr<T>::begin() const
+	template<typename T> constexpr const T* ArrayPtr<T>::begin() const
 	{
 		return ptr;
 	}
 	
-	template<typename T> T* ArrayPtr<T>::end()
+	template<typename T> constexpr T* ArrayPtr<T>::end()
 	{
 		return &ptr[len];
 	}
 	
-	template<typename T> const T* ArrayPtr<T>::end() const
+	template<typename T> constexpr const T* ArrayPtr<T>::end() const
 	{
 		return &ptr[len];
 	}
 	
-	template<typename T> ArrayPtr<T>::operator bool() const
+	template<typename T> constexpr ArrayPtr<T>::operator bool() const
 	{
 		return ptr;
 	}
 	
-	template<typename T> T*& ArrayPtr<T>::data()
+	template<typename T> constexpr T*& ArrayPtr<T>::data()
 	{
 		return ptr;
 	}
 	
-	template<typename T> const T* ArrayPtr<T>::data() const
+	template<typename T> constexpr const T* ArrayPtr<T>::data() const
 	{
 		return ptr;
 	}
 	
-	template<typename T> size_t& ArrayPtr<T>::size()
+	template<typename T> constexpr size_t& ArrayPtr<T>::size()
 	{
 		return len;
 	}
 	
-	template<typename T> size_t  ArrayPtr<T>::size() const
+	template<typename T> constexpr size_t  ArrayPtr<T>::size() const
 	{
 		return len;
 	}
 
-	template<typename T> size_t ArrayPtr<T>::byte_size() const
+	template<typename T> constexpr size_t ArrayPtr<T>::byte_size() const
 	{
 		return ::byte_size<T>(len);
 	}
@@ -240,48 +242,75 @@ namespace rcom
 
 	// Helper functions
 
-	template<typename T> inline bool operator==(ArrayPtr<T> ptr, std::nullptr_t)
+	template<typename T> inline constexpr bool operator==(ArrayPtr<T> ptr, std::nullptr_t)
 	{
 		return !ptr.operator bool();
 	}
 	
-	template<typename T> inline bool operator!=(ArrayPtr<T> ptr, std::nullptr_t)
+	template<typename T> inline constexpr bool operator!=(ArrayPtr<T> ptr, std::nullptr_t)
 	{
 		return !operator==(ptr, nullptr);
 	}
 
-	template<typename T> inline bool operator==(std::nullptr_t, ArrayPtr<T> ptr)
+	template<typename T> inline constexpr bool operator==(std::nullptr_t, ArrayPtr<T> ptr)
 	{
 		return operator==(ptr, nullptr);
 	}
 
-	template<typename T> inline bool operator!=(std::nullptr_t, ArrayPtr<T> ptr)
+	template<typename T> inline constexpr bool operator!=(std::nullptr_t, ArrayPtr<T> ptr)
 	{
 		return operator!=(ptr, nullptr);
 	}
 
-	template<typename T> inline ArrayPtr<T> to_ptr(T* ptr, size_t n)
+	template<typename T> inline constexpr ArrayPtr<T> to_ptr(T* ptr, size_t n)
 	{
 		return {ptr, n};
 	}
 	
-	template<typename T, size_t N> inline ArrayPtr<T> to_ptr(T (&arr)[N])
+	template<typename T, size_t N> inline constexpr ArrayPtr<T> to_ptr(T (&arr)[N])
 	{
 	    return {arr};
 	}
 
-	template<typename T> T* linear_search(ArrayPtr<T> ptr, const T& value)
+	// Value parameters use this so T is only deduced from the ArrayPtr
+	template<typename T> struct Identity
+	{
+		typedef T type;
+	};
+
+	// First element equal to value. Arithmetic types are compared with SIMD
+	template<typename T> T* linear_search(ArrayPtr<T> ptr, const typename Identity<T>::type& value)
 	{
 		RCOM_ASSERT(ptr, "Null pointer");
 
-		for(size_t i = 0; i < ptr.size(); ++i)
-		{
-			if(ptr[i] == value)
-			{
-				return &ptr[i];
-			}
-		}
-		return nullptr;
+		size_t i = hidden::find(ptr.data(), ptr.size(), value, true);
+		return i < ptr.size() ? &ptr.data()[i] : nullptr;
+	}
+
+	// First element not equal to value
+	template<typename T> T* find_first_not(ArrayPtr<T> ptr, const typename Identity<T>::type& value)
+	{
+		RCOM_ASSERT(ptr, "Null pointer");
+
+		size_t i = hidden::find(ptr.data(), ptr.size(), value, false);
+		return i < ptr.size() ? &ptr.data()[i] : nullptr;
+	}
+
+	// Number of elements equal to value
+	template<typename T> size_t count(ArrayPtr<T> ptr, const typename Identity<T>::type& value)
+	{
+		RCOM_ASSERT(ptr, "Null pointer");
+
+		return hidden::count(ptr.data(), ptr.size(), value);
+	}
+
+	// Write the indices of elements equal to value into out, stopping when out is full
+	// Return the number of indices written
+	template<typename T> size_t find_all(ArrayPtr<T> ptr, const typename Identity<T>::type& value, ArrayPtr<size_t> out)
+	{
+		RCOM_ASSERT(ptr && out, "Null pointer");
+
+		return hidden::find_all(ptr.data(), ptr.size(), value, out.data(), out.size());
 	}
 
 	inline void set_memory(BytePtr ptr, int val = 0)
@@ -328,7 +357,47 @@ namespace rcom
 
 	inline bool equate_memory(const BytePtr lhs, const BytePtr rhs)
 	{
-		return compare_memory(lhs, rhs) == 0;
+		RCOM_ASSERT(lhs && rhs, "Null pointer");
+
+		// No ordering needed, so stop at the first difference
+		return lhs.size() == rhs.size() && hidden::equal_bytes(lhs.data(), rhs.data(), lhs.size());
+	}
+
+	// Streaming variants. Stores bypass the cache so large copies do not evict the working set of other threads
+	// Only worth it for buffers much larger than the last level cache
+
+	inline void stream_set_memory(BytePtr ptr, int val = 0)
+	{
+		RCOM_ASSERT(ptr, "Null pointer");
+
+		hidden::stream_set(ptr.data(), val, ptr.byte_size());
+	}
+
+	inline void stream_copy_memory(BytePtr dst, const BytePtr src)
+	{
+		RCOM_ASSERT(dst && src, "Null pointer");
+		RCOM_ASSERT(dst.byte_size() >= src.byte_size(), "Array too small");
+
+		hidden::stream_copy(dst.data(), src.data(), src.byte_size());
+	}
+
+	inline void stream_move_memory(BytePtr dst, const BytePtr src)
+	{
+		RCOM_ASSERT(dst && src, "Null pointer");
+		RCOM_ASSERT(dst.byte_size() >= src.byte_size(), "Array too small");
+
+		const uint8_t* s = src.data();
+		const uint8_t* d = dst.data();
+
+		if(d + src.byte_size() <= s || s + src.byte_size() <= d)
+		{
+			hidden::stream_copy(dst.data(), src.data(), src.byte_size());
+		}
+		else
+		{
+			// Overlapping ranges need memmove ordering
+			memmove(dst.data(), src.data(), src.byte_size());
+		}
 	}
 }
 // namespace::rcom
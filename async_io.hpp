@@ -0,0 +1,725 @@
+#pragma once
+
+// Asynchronous reads and writes of BytePtr regions (POSIX)
+//
+// Operations are queued, handed over in batches with submit(), and their results collected with poll() or wait().
+// On Linux the requests go straight to the kernel through io_uring, so many reads can be in flight from one thread.
+// Where io_uring is missing or refused, a few worker threads run pread/pwrite instead, behind the same interface.
+// Buffers belong to the caller and must stay valid until their completion has been reaped.
+
+#include "dynamic_array.hpp"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && defined(__has_include)
+	#if __has_include(<linux/io_uring.h>)
+		#define RCOM_IO_URING 1
+		#include <linux/io_uring.h>
+		#include <sys/mman.h>
+		#include <sys/syscall.h>
+	#endif
+#endif
+
+namespace rcom
+{
+	enum class IoBackend
+	{
+		none,
+		io_uring,
+		threads
+	};
+
+	struct IoCompletion
+	{
+		uint64_t user_data;
+		// Bytes transferred, or -errno. Reads and writes may be short
+		int64_t  result;
+	};
+
+	class AsyncIo
+	{
+	public:
+		inline AsyncIo();
+		inline ~AsyncIo();
+
+		AsyncIo(const AsyncIo&)            = delete;
+		AsyncIo& operator=(const AsyncIo&) = delete;
+
+		// Allow up to entries operations in flight. Asking for io_uring falls back to threads if it cannot be set up
+		// Return false if neither backend could be started
+		inline bool open(uint32_t entries = 64, IoBackend backend = IoBackend::io_uring, uint32_t threads = 4);
+		inline void close();
+
+		inline IoBackend backend()   const;
+		inline uint32_t  capacity()  const;
+		// Queued, submitted or finished operations not yet reaped
+		inline uint32_t  in_flight() const;
+
+		// Queue an operation. Return false if capacity() operations are already in flight
+		inline bool read(int fd, BytePtr dst, uint64_t offset, uint64_t user_data);
+		inline bool write(int fd, ArrayPtr<const uint8_t> src, uint64_t offset, uint64_t user_data);
+
+		// Pin buffers with the kernel once so fixed reads and writes skip mapping them on every call
+		// Must not be called while operations are in flight. Return false if the kernel refused
+		inline bool register_buffers(ArrayPtr<const BytePtr> buffers);
+		inline void unregister_buffers();
+
+		// As read and write, but dst/src must lie inside registered buffer index
+		inline bool read_fixed(int fd, BytePtr dst, uint64_t offset, uint32_t index, uint64_t user_data);
+		inline bool write_fixed(int fd, ArrayPtr<const uint8_t> src, uint64_t offset, uint32_t index, uint64_t user_data);
+
+		// Hand every queued operation over in one batch. Return the number handed over
+		inline uint32_t submit();
+
+		// Copy finished operations into out without blocking. Return the number copied
+		inline size_t poll(ArrayPtr<IoCompletion> out);
+		// Submit anything queued, then block until at least min operations have finished and copy up to out.size() of them
+		inline size_t wait(ArrayPtr<IoCompletion> out, size_t min = 1);
+	private:
+		enum OpCode : uint8_t
+		{
+			op_read,
+			op_write,
+			op_read_fixed,
+			op_write_fixed
+		};
+
+		struct Op
+		{
+			uint8_t* buf;
+			size_t   len;
+			uint64_t offset;
+			uint64_t user_data;
+			int      fd;
+			OpCode   code;
+			uint32_t index;
+		};
+
+		IoBackend          mode;
+		uint32_t           entries;
+		uint32_t           outstanding;
+		uint32_t           staged;
+		DynamicArray<BytePtr> registered;
+
+#if defined(RCOM_IO_URING)
+		// io_uring rings shared with the kernel
+		struct Ring
+		{
+			int             fd;
+			BytePtr         sq_map;
+			BytePtr         cq_map;
+			BytePtr         sqe_map;
+			uint32_t*       sq_head;
+			uint32_t*       sq_tail;
+			uint32_t*       sq_array;
+			uint32_t        sq_mask;
+			uint32_t        sq_entries;
+			io_uring_sqe*   sqes;
+			uint32_t*       cq_head;
+			uint32_t*       cq_tail;
+			uint32_t        cq_mask;
+			io_uring_cqe*   cqes;
+			uint32_t        local_tail;
+		};
+
+		Ring ring;
+
+		inline bool   uring_open(uint32_t n);
+		inline bool   uring_probe();
+		inline void   uring_drain();
+		inline void   uring_close();
+		inline void   uring_queue(const Op& op);
+		inline size_t uring_reap(ArrayPtr<IoCompletion> out);
+#endif
+
+		// Worker threads running pread/pwrite. Ops and completions are rings of entries slots guarded by mutex
+		DynamicArray<std::thread> workers;
+		std::mutex                mutex;
+		std::condition_variable   work_ready;
+		std::condition_variable   done_ready;
+		ArrayPtr<Op>              ops;
+		ArrayPtr<IoCompletion>    done;
+		size_t                    op_head;
+		size_t                    op_tail;
+		size_t                    done_head;
+		size_t                    done_tail;
+		bool                      stopping;
+
+		inline bool   threads_open(uint32_t n, uint32_t threads);
+		inline void   threads_close();
+		inline void   threads_queue(const Op& op);
+		inline size_t threads_reap(ArrayPtr<IoCompletion> out);
+		inline void   work();
+
+		inline bool queue(const Op& op);
+	};
+
+	AsyncIo::AsyncIo() :
+		mode{IoBackend::none},
+		entries{0},
+		outstanding{0},
+		staged{0},
+		registered{},
+#if defined(RCOM_IO_URING)
+		ring{},
+#endif
+		workers{},
+		ops{},
+		done{},
+		op_head{0},
+		op_tail{0},
+		done_head{0},
+		done_tail{0},
+		stopping{false}
+	{
+	}
+
+	AsyncIo::~AsyncIo()
+	{
+		close();
+	}
+
+	bool AsyncIo::open(uint32_t n, IoBackend backend, uint32_t threads)
+	{
+		RCOM_ASSERT(n > 0, "Need at least one entry");
+
+		close();
+
+#if defined(RCOM_IO_URING)
+		if(backend == IoBackend::io_uring && uring_open(n))
+		{
+			mode = IoBackend::io_uring;
+			return true;
+		}
+#else
+		(void)backend;
+#endif
+
+		if(threads_open(n, threads ? threads : 1))
+		{
+			mode = IoBackend::threads;
+			return true;
+		}
+		return false;
+	}
+
+	void AsyncIo::close()
+	{
+#if defined(RCOM_IO_URING)
+		if(mode == IoBackend::io_uring)
+		{
+			uring_drain();
+			uring_close();
+		}
+#endif
+
+		if(mode == IoBackend::threads)
+		{
+			threads_close();
+		}
+
+		registered.clear();
+
+		mode        = IoBackend::none;
+		entries     = 0;
+		outstanding = 0;
+		staged      = 0;
+	}
+
+	IoBackend AsyncIo::backend() const
+	{
+		return mode;
+	}
+
+	uint32_t AsyncIo::capacity() const
+	{
+		return entries;
+	}
+
+	uint32_t AsyncIo::in_flight() const
+	{
+		return outstanding;
+	}
+
+	bool AsyncIo::queue(const Op& op)
+	{
+		RCOM_ASSERT(mode != IoBackend::none, "AsyncIo is not open");
+		RCOM_ASSERT(op.len <= UINT32_MAX,    "Operation too large");
+
+		if(outstanding == entries)
+		{
+			return false;
+		}
+
+#if defined(RCOM_IO_URING)
+		if(mode == IoBackend::io_uring)
+		{
+			uring_queue(op);
+		}
+		else
+#endif
+		{
+			threads_queue(op);
+		}
+
+		++outstanding;
+		++staged;
+		return true;
+	}
+
+	bool AsyncIo::read(int fd, BytePtr dst, uint64_t offset, uint64_t user_data)
+	{
+		return queue({dst.data(), dst.size(), offset, user_data, fd, op_read, 0});
+	}
+
+	bool AsyncIo::write(int fd, ArrayPtr<const uint8_t> src, uint64_t offset, uint64_t user_data)
+	{
+		return queue({const_cast<uint8_t*>(src.data()), src.size(), offset, user_data, fd, op_write, 0});
+	}
+
+	bool AsyncIo::read_fixed(int fd, BytePtr dst, uint64_t offset, uint32_t index, uint64_t user_data)
+	{
+		RCOM_ASSERT(index < registered.size(), "Buffer is not registered");
+		RCOM_ASSERT(dst.data() >= registered[index].data() && dst.data() + dst.size() <= registered[index].end(), "Not inside the registered buffer");
+
+		return queue({dst.data(), dst.size(), offset, user_data, fd, op_read_fixed, index});
+	}
+
+	bool AsyncIo::write_fixed(int fd, ArrayPtr<const uint8_t> src, uint64_t offset, uint32_t index, uint64_t user_data)
+	{
+		RCOM_ASSERT(index < registered.size(), "Buffer is not registered");
+		RCOM_ASSERT(src.data() >= registered[index].data() && src.data() + src.size() <= registered[index].end(), "Not inside the registered buffer");
+
+		return queue({const_cast<uint8_t*>(src.data()), src.size(), offset, user_data, fd, op_write_fixed, index});
+	}
+
+	bool AsyncIo::register_buffers(ArrayPtr<const BytePtr> buffers)
+	{
+		RCOM_ASSERT(mode != IoBackend::none, "AsyncIo is not open");
+		RCOM_ASSERT(outstanding == 0,        "Operations in flight");
+
+		unregister_buffers();
+
+		if(!registered.reserve(buffers.size()))
+		{
+			return false;
+		}
+
+#if defined(RCOM_IO_URING)
+		if(mode == IoBackend::io_uring && buffers.size())
+		{
+			DynamicArray<iovec> iov;
+
+			if(!iov.reserve(buffers.size()))
+			{
+				return false;
+			}
+
+			for(const BytePtr& b : buffers)
+			{
+				iov.push({const_cast<uint8_t*>(b.data()), b.size()});
+			}
+
+			if(syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS, iov.data(), static_cast<unsigned>(iov.size())) < 0)
+			{
+				return false;
+			}
+		}
+#endif
+
+		for(const BytePtr& b : buffers)
+		{
+			registered.push(b);
+		}
+		return true;
+	}
+
+	void AsyncIo::unregister_buffers()
+	{
+		RCOM_ASSERT(outstanding == 0, "Operations in flight");
+
+#if defined(RCOM_IO_URING)
+		if(mode == IoBackend::io_uring && registered.size())
+		{
+			syscall(__NR_io_uring_register, ring.fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+		}
+#endif
+
+		registered.clear();
+	}
+
+	uint32_t AsyncIo::submit()
+	{
+		uint32_t n = staged;
+
+		if(n == 0)
+		{
+			return 0;
+		}
+
+#if defined(RCOM_IO_URING)
+		if(mode == IoBackend::io_uring)
+		{
+			__atomic_store_n(ring.sq_tail, ring.local_tail, __ATOMIC_RELEASE);
+
+			uint32_t left = n;
+
+			while(left)
+			{
+				long r = syscall(__NR_io_uring_enter, ring.fd, left, 0, 0, nullptr, 0);
+
+				if(r < 0)
+				{
+					if(errno == EINTR || errno == EAGAIN || errno == EBUSY)
+					{
+						continue;
+					}
+					break;
+				}
+
+				left -= static_cast<uint32_t>(r);
+			}
+
+			staged = left;
+			return n - left;
+		}
+#endif
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			op_tail += n;
+		}
+
+		staged = 0;
+		work_ready.notify_all();
+		return n;
+	}
+
+	size_t AsyncIo::poll(ArrayPtr<IoCompletion> out)
+	{
+		size_t n = 0;
+
+#if defined(RCOM_IO_URING)
+		if(mode == IoBackend::io_uring)
+		{
+			n = uring_reap(out);
+		}
+		else
+#endif
+		if(mode == IoBackend::threads)
+		{
+			n = threads_reap(out);
+		}
+
+		outstanding -= static_cast<uint32_t>(n);
+		return n;
+	}
+
+	size_t AsyncIo::wait(ArrayPtr<IoCompletion> out, size_t min)
+	{
+		submit();
+
+		// Only what has been handed over can finish
+		size_t submitted = outstanding - staged;
+		min              = min < submitted ? min : submitted;
+		min              = min < out.size() ? min : out.size();
+
+		size_t n = poll(out);
+
+		while(n < min)
+		{
+			ArrayPtr<IoCompletion> rest = out.slice(n);
+
+#if defined(RCOM_IO_URING)
+			if(mode == IoBackend::io_uring)
+			{
+				long r = syscall(__NR_io_uring_enter, ring.fd, 0, static_cast<unsigned>(min - n), IORING_ENTER_GETEVENTS, nullptr, 0);
+
+				if(r < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					break;
+				}
+			}
+			else
+#endif
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				done_ready.wait(lock, [&]{return done_tail - done_head >= min - n;});
+			}
+
+			n += poll(rest);
+		}
+		return n;
+	}
+
+#if defined(RCOM_IO_URING)
+	bool AsyncIo::uring_open(uint32_t n)
+	{
+		io_uring_params p;
+		memset(&p, 0, sizeof(p));
+
+		int fd = static_cast<int>(syscall(__NR_io_uring_setup, n, &p));
+
+		if(fd < 0)
+		{
+			return false;
+		}
+
+		ring    = {};
+		ring.fd = fd;
+
+		size_t sq_size  = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+		size_t cq_size  = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+		size_t sqe_size = p.sq_entries * sizeof(io_uring_sqe);
+		bool   single   = p.features & IORING_FEAT_SINGLE_MMAP;
+
+		if(single)
+		{
+			sq_size = cq_size = sq_size > cq_size ? sq_size : cq_size;
+		}
+
+		void* sq = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		void* cq = single ? sq : mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+		void* se = mmap(nullptr, sqe_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+
+		ring.sq_map  = sq == MAP_FAILED ? BytePtr{} : BytePtr{static_cast<uint8_t*>(sq), sq_size};
+		ring.cq_map  = cq == MAP_FAILED || single ? BytePtr{} : BytePtr{static_cast<uint8_t*>(cq), cq_size};
+		ring.sqe_map = se == MAP_FAILED ? BytePtr{} : BytePtr{static_cast<uint8_t*>(se), sqe_size};
+
+		if(sq == MAP_FAILED || cq == MAP_FAILED || se == MAP_FAILED)
+		{
+			uring_close();
+			return false;
+		}
+
+		uint8_t* s = static_cast<uint8_t*>(sq);
+		uint8_t* c = static_cast<uint8_t*>(cq);
+
+		ring.sq_head    = reinterpret_cast<uint32_t*>(s + p.sq_off.head);
+		ring.sq_tail    = reinterpret_cast<uint32_t*>(s + p.sq_off.tail);
+		ring.sq_array   = reinterpret_cast<uint32_t*>(s + p.sq_off.array);
+		ring.sq_mask    = *reinterpret_cast<uint32_t*>(s + p.sq_off.ring_mask);
+		ring.sq_entries = p.sq_entries;
+		ring.sqes       = static_cast<io_uring_sqe*>(se);
+		ring.cq_head    = reinterpret_cast<uint32_t*>(c + p.cq_off.head);
+		ring.cq_tail    = reinterpret_cast<uint32_t*>(c + p.cq_off.tail);
+		ring.cq_mask    = *reinterpret_cast<uint32_t*>(c + p.cq_off.ring_mask);
+		ring.cqes       = reinterpret_cast<io_uring_cqe*>(c + p.cq_off.cqes);
+		ring.local_tail = *ring.sq_tail;
+
+		if(!uring_probe())
+		{
+			uring_close();
+			return false;
+		}
+
+		// The completion ring is at least as large, so it cannot overflow
+		entries = p.sq_entries;
+		return true;
+	}
+
+	bool AsyncIo::uring_probe()
+	{
+		// Plain reads and writes arrived in Linux 5.6, along with the probe itself. Older kernels refuse the probe
+		alignas(io_uring_probe) uint8_t buf[sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op)];
+		memset(buf, 0, sizeof(buf));
+
+		io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buf);
+
+		if(syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0)
+		{
+			return false;
+		}
+
+		for(uint8_t op : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED})
+		{
+			if(op >= probe->ops_len || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void AsyncIo::uring_drain()
+	{
+		// The kernel keeps running submitted operations after the ring is closed, so wait for them while their buffers are still valid
+		// Queued operations were never published to the kernel and are simply dropped
+		IoCompletion discard[16];
+		uint32_t     pending = outstanding - staged;
+
+		while(pending)
+		{
+			long r = syscall(__NR_io_uring_enter, ring.fd, 0, pending, IORING_ENTER_GETEVENTS, nullptr, 0);
+
+			if(r < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+			{
+				break;
+			}
+
+			size_t n;
+
+			while(pending && (n = uring_reap(discard)) != 0)
+			{
+				pending -= static_cast<uint32_t>(n < pending ? n : pending);
+			}
+		}
+	}
+
+	void AsyncIo::uring_close()
+	{
+		if(ring.sqe_map) munmap(ring.sqe_map.data(), ring.sqe_map.size());
+		if(ring.cq_map)  munmap(ring.cq_map.data(),  ring.cq_map.size());
+		if(ring.sq_map)  munmap(ring.sq_map.data(),  ring.sq_map.size());
+
+		::close(ring.fd);
+		ring = {};
+	}
+
+	void AsyncIo::uring_queue(const Op& op)
+	{
+		static const uint8_t opcodes[] = {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED};
+
+		uint32_t      i   = ring.local_tail & ring.sq_mask;
+		io_uring_sqe& sqe = ring.sqes[i];
+
+		memset(&sqe, 0, sizeof(sqe));
+		sqe.opcode    = opcodes[op.code];
+		sqe.fd        = op.fd;
+		sqe.off       = op.offset;
+		sqe.addr      = reinterpret_cast<uint64_t>(op.buf);
+		sqe.len       = static_cast<uint32_t>(op.len);
+		sqe.user_data = op.user_data;
+		sqe.buf_index = static_cast<uint16_t>(op.index);
+
+		ring.sq_array[i] = i;
+		++ring.local_tail;
+	}
+
+	size_t AsyncIo::uring_reap(ArrayPtr<IoCompletion> out)
+	{
+		uint32_t head = *ring.cq_head;
+		uint32_t tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+		size_t   n    = 0;
+
+		for(; head != tail && n < out.size(); ++head, ++n)
+		{
+			const io_uring_cqe& cqe = ring.cqes[head & ring.cq_mask];
+			out.data()[n]           = {cqe.user_data, cqe.res};
+		}
+
+		__atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+		return n;
+	}
+#endif
+
+	bool AsyncIo::threads_open(uint32_t n, uint32_t threads)
+	{
+		MallocAllocator alloc;
+
+		ops  = allocate_array<Op>(alloc, n);
+		done = allocate_array<IoCompletion>(alloc, n);
+
+		if(!ops || !done || !workers.reserve(threads))
+		{
+			threads_close();
+			return false;
+		}
+
+		op_head   = 0;
+		op_tail   = 0;
+		done_head = 0;
+		done_tail = 0;
+		stopping  = false;
+		entries   = n;
+
+		for(uint32_t i = 0; i < threads; ++i)
+		{
+			workers.emplace([this]{work();});
+		}
+		return true;
+	}
+
+	void AsyncIo::threads_close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		work_ready.notify_all();
+
+		// Workers finish the submitted operations first, buffers must not be freed under them
+		for(std::thread& t : workers)
+		{
+			t.join();
+		}
+
+		MallocAllocator alloc;
+		deallocate_array(alloc, ops);
+		deallocate_array(alloc, done);
+
+		workers.clear();
+		ops  = nullptr;
+		done = nullptr;
+	}
+
+	void AsyncIo::threads_queue(const Op& op)
+	{
+		// Slots past op_tail are only touched by this thread until submit publishes them
+		ops.data()[(op_tail + staged) % ops.size()] = op;
+	}
+
+	size_t AsyncIo::threads_reap(ArrayPtr<IoCompletion> out)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t n = 0;
+
+		for(; done_head != done_tail && n < out.size(); ++done_head, ++n)
+		{
+			out.data()[n] = done.data()[done_head % done.size()];
+		}
+		return n;
+	}
+
+	void AsyncIo::work()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		for(;;)
+		{
+			work_ready.wait(lock, [&]{return stopping || op_head != op_tail;});
+
+			if(op_head == op_tail)
+			{
+				return;
+			}
+
+			Op op = ops.data()[op_head++ % ops.size()];
+			lock.unlock();
+
+			bool    reading = op.code == op_read || op.code == op_read_fixed;
+			ssize_t r;
+
+			do
+			{
+				r = reading ? pread(op.fd, op.buf, op.len, static_cast<off_t>(op.offset)) : pwrite(op.fd, op.buf, op.len, static_cast<off_t>(op.offset));
+			}
+			while(r < 0 && errno == EINTR);
+
+			int64_t result = r < 0 ? -static_cast<int64_t>(errno) : static_cast<int64_t>(r);
+
+			lock.lock();
+			done.data()[done_tail++ % done.size()] = {op.user_data, result};
+			done_ready.notify_all();
+		}
+	}
+}
+// namespace::rcom
@@ -27,6 +27,11 @@
 // Size of a carray
 #define RCOM_CARRAY_SIZE(ARR) (sizeof(ARR) / sizeof(*ARR))
 
+// Size of a cache line. Used to keep data written by different threads apart
+#if !defined(RCOM_CACHE_LINE_SIZE)
+	#define RCOM_CACHE_LINE_SIZE 64
+#endif
+
 // Asserts
 namespace rcom { namespace hidden
 {
@@ -49,7 +54,7 @@ namespace rcom { namespace hidden
 // namespace rcom::hidden
 
 #if defined(RCOM_ASSERTS_ENABLED)
-	#define RCOM_ASSERT(x, msg, ...) if(!(x)) rcom::hidden::assert_imp("Failed Assertion: " msg " at: " RCOM_CODE_LOCATION, __VA_ARGS__)
+	#define RCOM_ASSERT(x, msg, ...) do{if(!(x)) rcom::hidden::assert_imp("Failed Assertion: " msg " at: " RCOM_CODE_LOCATION, ##__VA_ARGS__);}while(0)
 #else
 	#define RCOM_ASSERT(x, msg, ...)
 #endif
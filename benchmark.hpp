@@ -0,0 +1,161 @@
+#pragma once
+
+// Micro benchmark harness
+//
+// Each benchmark is warmed up, then timed over a number of repetitions.
+// A repetition runs the function enough times to last at least min_time_ns so timer overhead is negligible.
+// Results are reported per call as the median and percentiles over repetitions.
+
+#include "clock.hpp"
+#include "dynamic_array.hpp"
+#include <algorithm>
+
+namespace rcom
+{
+	// Make the compiler assume value is read, so the code producing it is not removed
+	template<typename T> inline void do_not_optimize(const T& value)
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static volatile const void* sink;
+		sink = &value;
+#endif
+	}
+
+	// Make the compiler assume all memory is read and written
+	inline void clobber_memory()
+	{
+#if defined(__GNUC__)
+		asm volatile("" : : : "memory");
+#endif
+	}
+
+	struct BenchmarkOptions
+	{
+		size_t warmup      = 3;
+		// Timed runs, clamped to at least 1
+		size_t repetitions = 31;
+		double min_time_ns = 1000000;
+		// Bytes touched per call, used to report throughput. 0 to omit
+		size_t bytes       = 0;
+	};
+
+	// Times are nanoseconds per call
+	struct BenchmarkResult
+	{
+		const char* name;
+		size_t      calls;
+		double      min;
+		double      median;
+		double      p90;
+		double      p99;
+		double      max;
+		double      cycles;
+		size_t      bytes;
+	};
+
+	namespace hidden
+	{
+		template<typename Func> inline uint64_t time_calls(Func& func, size_t calls)
+		{
+			uint64_t start = read_nanoseconds();
+
+			for(size_t i = 0; i < calls; ++i)
+			{
+				func();
+				clobber_memory();
+			}
+
+			return read_nanoseconds() - start;
+		}
+
+		inline double percentile(ArrayPtr<const double> sorted, double p)
+		{
+			size_t i = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+			return sorted[i];
+		}
+	}
+	// namespace hidden
+
+	template<typename Func> BenchmarkResult run_benchmark(const char* name, Func func, BenchmarkOptions options = BenchmarkOptions{})
+	{
+		RCOM_ASSERT(options.repetitions > 0, "Benchmark needs at least one repetition");
+		options.repetitions = std::max<size_t>(1, options.repetitions);
+
+		// Find how many calls fill the minimum time
+		size_t calls = 1;
+
+		for(;;)
+		{
+			uint64_t t = hidden::time_calls(func, calls);
+
+			if(static_cast<double>(t) >= options.min_time_ns || calls >= (size_t(1) << 40))
+			{
+				break;
+			}
+
+			calls *= t > 0 ? std::min<size_t>(16, std::max<size_t>(2, static_cast<size_t>(options.min_time_ns / static_cast<double>(t)) + 1)) : 16;
+		}
+
+		for(size_t i = 0; i < options.warmup; ++i)
+		{
+			hidden::time_calls(func, calls);
+		}
+
+		DynamicArray<double> samples;
+		samples.reserve(options.repetitions);
+
+		uint64_t cycles = 0;
+
+		for(size_t i = 0; i < options.repetitions; ++i)
+		{
+			uint64_t c = read_cycles();
+			uint64_t t = hidden::time_calls(func, calls);
+			cycles    += read_cycles() - c;
+			samples.push(static_cast<double>(t) / static_cast<double>(calls));
+		}
+
+		std::sort(samples.begin(), samples.end());
+
+		ArrayPtr<const double> s = samples.to_ptr();
+
+		BenchmarkResult r;
+		r.name   = name;
+		r.calls  = calls;
+		r.min    = s.first();
+		r.median = hidden::percentile(s, 0.5);
+		r.p90    = hidden::percentile(s, 0.9);
+		r.p99    = hidden::percentile(s, 0.99);
+		r.max    = s.last();
+		r.cycles = static_cast<double>(cycles) / static_cast<double>(calls * options.repetitions);
+		r.bytes  = options.bytes;
+		return r;
+	}
+
+	inline void print_benchmark_header(FILE* out = stdout)
+	{
+		fprintf(out, "%-40s %12s %12s %12s %12s %12s %10s\n", "name", "median ns", "min ns", "p90 ns", "p99 ns", "cycles", "GB/s");
+	}
+
+	inline void print_benchmark(const BenchmarkResult& r, FILE* out = stdout)
+	{
+		fprintf(out, "%-40s %12.2f %12.2f %12.2f %12.2f %12.1f", r.name, r.median, r.min, r.p90, r.p99, r.cycles);
+
+		if(r.bytes)
+		{
+			fprintf(out, " %10.2f\n", static_cast<double>(r.bytes) / r.median);
+		}
+		else
+		{
+			fprintf(out, " %10s\n", "-");
+		}
+	}
+
+	// Machine readable, one line per result
+	inline void print_benchmark_csv(const BenchmarkResult& r, FILE* out = stdout)
+	{
+		fprintf(out, "%s,%zu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%zu\n", r.name, r.calls, r.median, r.min, r.p90, r.p99, r.max, r.cycles, r.bytes);
+	}
+}
+// namespace::rcom
@@ -0,0 +1,317 @@
+// Benchmarks for the ArrayPtr/Array helpers against std::vector and std::span
+//
+// Build and run with and without asserts to see their cost:
+//   g++ -O2 -std=c++17 -I. benchmark_suite.cpp -o benchmark_suite -pthread
+//   g++ -O2 -std=c++17 -I. -DRCOM_ASSERTS_ENABLED benchmark_suite.cpp -o benchmark_suite_asserts -pthread
+// Build with -std=c++20 to include the std::span rows. Pass --csv for machine readable output.
+
+#include "array.hpp"
+#include "benchmark.hpp"
+#include "soa.hpp"
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+#if defined(__has_include)
+	#if __has_include(<span>)
+		#include <span>
+	#endif
+#endif
+
+#if defined(__cpp_lib_span)
+	#define RCOM_BENCH_SPAN 1
+#endif
+
+namespace
+{
+	bool csv = false;
+
+	template<typename Func> void bench(const char* name, Func func, size_t bytes = 0)
+	{
+		rcom::BenchmarkOptions options;
+		options.bytes = bytes;
+
+		rcom::BenchmarkResult r = rcom::run_benchmark(name, func, options);
+
+		if(csv)
+		{
+			rcom::print_benchmark_csv(r);
+		}
+		else
+		{
+			rcom::print_benchmark(r);
+		}
+	}
+
+	void bench_search()
+	{
+		const size_t n = 1 << 20;
+
+		std::vector<int32_t> v(n);
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			v[i] = static_cast<int32_t>(i);
+		}
+
+		rcom::ArrayPtr<int32_t> p{v.data(), v.size()};
+		int32_t needle = static_cast<int32_t>(n - 1);
+
+		bench("linear_search/rcom/int32/1M", [&]
+		{
+			rcom::do_not_optimize(rcom::linear_search(p, needle));
+		}, n * sizeof(int32_t));
+
+		bench("linear_search/indexed_loop/int32/1M", [&]
+		{
+			int32_t* r = nullptr;
+
+			for(size_t i = 0; i < p.size(); ++i)
+			{
+				if(p[i] == needle)
+				{
+					r = &p[i];
+					break;
+				}
+			}
+			rcom::do_not_optimize(r);
+		}, n * sizeof(int32_t));
+
+		bench("linear_search/std_find_vector/int32/1M", [&]
+		{
+			rcom::do_not_optimize(std::find(v.begin(), v.end(), needle));
+		}, n * sizeof(int32_t));
+
+#if defined(RCOM_BENCH_SPAN)
+		std::span<int32_t> s{v.data(), v.size()};
+
+		bench("linear_search/std_find_span/int32/1M", [&]
+		{
+			rcom::do_not_optimize(std::find(s.begin(), s.end(), needle));
+		}, n * sizeof(int32_t));
+#endif
+
+		bench("count/rcom/int32/1M", [&]
+		{
+			rcom::do_not_optimize(rcom::count(p, needle));
+		}, n * sizeof(int32_t));
+
+		bench("count/std_count_vector/int32/1M", [&]
+		{
+			rcom::do_not_optimize(std::count(v.begin(), v.end(), needle));
+		}, n * sizeof(int32_t));
+	}
+
+	void bench_slice()
+	{
+		const size_t n = 4096;
+
+		std::vector<int32_t> v(n, 1);
+		rcom::ArrayPtr<int32_t> p{v.data(), v.size()};
+
+		bench("slice/rcom/4096x16", [&]
+		{
+			for(size_t i = 0; i + 16 <= n; ++i)
+			{
+				rcom::ArrayPtr<int32_t> s = p.slice(i, i + 16);
+				rcom::do_not_optimize(s);
+			}
+		});
+
+#if defined(RCOM_BENCH_SPAN)
+		std::span<int32_t> sp{v.data(), v.size()};
+
+		bench("slice/std_subspan/4096x16", [&]
+		{
+			for(size_t i = 0; i + 16 <= n; ++i)
+			{
+				std::span<int32_t> s = sp.subspan(i, 16);
+				rcom::do_not_optimize(s);
+			}
+		});
+#endif
+	}
+
+	void bench_memory(size_t n, const char* size_name)
+	{
+		std::vector<uint8_t> a(n, 1);
+		std::vector<uint8_t> b(n, 1);
+
+		rcom::BytePtr pa{a.data(), a.size()};
+		rcom::BytePtr pb{b.data(), b.size()};
+
+		char name[128];
+
+		snprintf(name, sizeof(name), "copy_memory/%s", size_name);
+		bench(name, [&]{rcom::copy_memory(pb, pa);}, n);
+
+		snprintf(name, sizeof(name), "stream_copy_memory/%s", size_name);
+		bench(name, [&]{rcom::stream_copy_memory(pb, pa);}, n);
+
+		snprintf(name, sizeof(name), "move_memory/%s", size_name);
+		bench(name, [&]{rcom::move_memory(pb, pa);}, n);
+
+		snprintf(name, sizeof(name), "set_memory/%s", size_name);
+		bench(name, [&]{rcom::set_memory(pb, 1);}, n);
+
+		snprintf(name, sizeof(name), "stream_set_memory/%s", size_name);
+		bench(name, [&]{rcom::stream_set_memory(pb, 1);}, n);
+
+		snprintf(name, sizeof(name), "compare_memory/%s", size_name);
+		bench(name, [&]{rcom::do_not_optimize(rcom::compare_memory(pa, pb));}, n);
+
+		snprintf(name, sizeof(name), "equate_memory/%s", size_name);
+		bench(name, [&]{rcom::do_not_optimize(rcom::equate_memory(pa, pb));}, n);
+
+		snprintf(name, sizeof(name), "memcmp/%s", size_name);
+		bench(name, [&]{rcom::do_not_optimize(memcmp(a.data(), b.data(), n) == 0);}, n);
+	}
+
+	RCOM_SOA_FIELD(IterValue,  int32_t);
+	RCOM_SOA_FIELD(IterWeight, float);
+
+	void bench_iteration()
+	{
+		const size_t n = 1 << 16;
+
+		static rcom::Array<int32_t, n> arr;
+		std::vector<int32_t> v(n, 1);
+
+		for(int32_t& x : arr)
+		{
+			x = 1;
+		}
+
+		bench("iterate/rcom_array_range_for/64K", [&]
+		{
+			int32_t sum = 0;
+
+			for(int32_t x : arr)
+			{
+				sum += x;
+			}
+			rcom::do_not_optimize(sum);
+		}, n * sizeof(int32_t));
+
+		bench("iterate/rcom_array_index/64K", [&]
+		{
+			int32_t sum = 0;
+
+			for(size_t i = 0; i < arr.size(); ++i)
+			{
+				sum += arr[i];
+			}
+			rcom::do_not_optimize(sum);
+		}, n * sizeof(int32_t));
+
+		rcom::ArrayPtr<int32_t> p = arr.to_ptr();
+
+		bench("iterate/rcom_array_ptr_index/64K", [&]
+		{
+			int32_t sum = 0;
+
+			for(size_t i = 0; i < p.size(); ++i)
+			{
+				sum += p[i];
+			}
+			rcom::do_not_optimize(sum);
+		}, n * sizeof(int32_t));
+
+		bench("iterate/std_vector_index/64K", [&]
+		{
+			int32_t sum = 0;
+
+			for(size_t i = 0; i < v.size(); ++i)
+			{
+				sum += v[i];
+			}
+			rcom::do_not_optimize(sum);
+		}, n * sizeof(int32_t));
+
+		static rcom::SoaArray<n, IterValue, IterWeight> soa;
+		const rcom::SoaArray<n, IterValue, IterWeight>& soa_view = soa;
+
+		for(int32_t& x : soa.column<IterValue>())
+		{
+			x = 1;
+		}
+
+		// Read through a const container, as most consumers of a column do
+		bench("iterate/rcom_soa_const_column/64K", [&]
+		{
+			rcom::ArrayPtr<const int32_t> c   = soa_view.column<IterValue>();
+			int32_t                       sum = 0;
+
+			for(size_t i = 0; i < c.size(); ++i)
+			{
+				sum += c[i];
+			}
+			rcom::do_not_optimize(sum);
+		}, n * sizeof(int32_t));
+
+		rcom::DynamicSoaArray<IterValue, IterWeight> dsoa;
+		const rcom::DynamicSoaArray<IterValue, IterWeight>& dsoa_view = dsoa;
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			dsoa.push(1, 1.0f);
+		}
+
+		bench("iterate/rcom_dynamic_soa_const_row/64K", [&]
+		{
+			int32_t sum = 0;
+
+			for(size_t i = 0; i < dsoa_view.size(); ++i)
+			{
+				sum += dsoa_view[i].get<IterValue>();
+			}
+			rcom::do_not_optimize(sum);
+		}, n * sizeof(int32_t));
+
+#if defined(RCOM_BENCH_SPAN)
+		std::span<int32_t> s{v.data(), v.size()};
+
+		bench("iterate/std_span_index/64K", [&]
+		{
+			int32_t sum = 0;
+
+			for(size_t i = 0; i < s.size(); ++i)
+			{
+				sum += s[i];
+			}
+			rcom::do_not_optimize(sum);
+		}, n * sizeof(int32_t));
+#endif
+	}
+}
+
+int main(int argc, char** argv)
+{
+	for(int i = 1; i < argc; ++i)
+	{
+		csv = csv || strcmp(argv[i], "--csv") == 0;
+	}
+
+#if defined(RCOM_ASSERTS_ENABLED)
+	const char* asserts = "on";
+#else
+	const char* asserts = "off";
+#endif
+
+	if(csv)
+	{
+		printf("name,calls,median_ns,min_ns,p90_ns,p99_ns,max_ns,cycles,bytes\n");
+	}
+	else
+	{
+		printf("asserts: %s, cycles per ns: %.2f\n", asserts, rcom::cycles_per_nanosecond());
+		rcom::print_benchmark_header();
+	}
+
+	bench_search();
+	bench_slice();
+	bench_memory(64 * 1024, "64K");
+	bench_memory(64 * 1024 * 1024, "64M");
+	bench_iteration();
+	return 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Timers for measuring short sections of code
+
+#include "cpu.hpp"
+#include <chrono>
+
+namespace rcom
+{
+	// Monotonic time in nanoseconds
+	inline uint64_t read_nanoseconds()
+	{
+		auto t = std::chrono::steady_clock::now().time_since_epoch();
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t).count());
+	}
+
+	// Cycle counter. Much cheaper to read than the clock but only meaningful as a difference on one machine
+	// Falls back to nanoseconds where there is no counter
+	inline uint64_t read_cycles()
+	{
+#if defined(RCOM_X86)
+		return __rdtsc();
+#else
+		return read_nanoseconds();
+#endif
+	}
+
+	// Cycle counter ticks per nanosecond. Measured once, takes about 10ms on first call
+	inline double cycles_per_nanosecond()
+	{
+		static const double ratio = []()
+		{
+			uint64_t ns0 = read_nanoseconds();
+			uint64_t c0  = read_cycles();
+
+			while(read_nanoseconds() - ns0 < 10000000)
+			{
+			}
+
+			uint64_t ns1 = read_nanoseconds();
+			uint64_t c1  = read_cycles();
+			return static_cast<double>(c1 - c0) / static_cast<double>(ns1 - ns0);
+		}();
+		return ratio;
+	}
+
+	inline double cycles_to_nanoseconds(uint64_t cycles)
+	{
+		return static_cast<double>(cycles) / cycles_per_nanosecond();
+	}
+}
+// namespace::rcom
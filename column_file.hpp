@@ -0,0 +1,590 @@
+#pragma once
+
+// Versioned binary file of named columns, loaded back as zero copy views into a MappedFile (POSIX)
+//
+// Layout: ColumnFileHeader, a table of ColumnInfo, then each column's elements at an aligned offset.
+// Opening checks the header and table checksum. Column checksums are only read by verify(),
+// since touching every page of a large file would undo the point of mapping it.
+
+#include "array.hpp"
+#include "cpu.hpp"
+#include "dynamic_array.hpp"
+#include "mapped_file.hpp"
+#include <cerrno>
+#include <cstring>
+
+// Column data starts on a multiple of this, or of the element alignment if larger
+#ifndef RCOM_COLUMN_ALIGN
+	#define RCOM_COLUMN_ALIGN 64
+#endif
+
+namespace rcom
+{
+	// CRC-32C (Castagnoli) of bytes, continuing from crc. Uses the SSE4.2 instruction when available
+	inline uint32_t crc32c(ArrayPtr<const uint8_t> bytes, uint32_t crc = 0);
+
+	// Element type tag stored with each column
+	enum class ColumnType : uint32_t
+	{
+		// Any other trivially copyable type, matched on size only
+		raw,
+		int8,
+		int16,
+		int32,
+		int64,
+		uint8,
+		uint16,
+		uint32,
+		uint64,
+		float32,
+		float64
+	};
+
+	template<typename T> inline constexpr ColumnType column_type();
+
+	// Highest rank of Array that can be stored
+	constexpr const size_t column_max_rank = 6;
+
+	struct ColumnFileHeader
+	{
+		char     magic[8];
+		uint32_t version;
+		// 0x01020304 as written, rejects files from a machine of the other byte order
+		uint32_t endian;
+		uint32_t column_count;
+		// Over the header with this field zeroed, then the column table
+		uint32_t table_crc;
+		uint64_t file_size;
+	};
+
+	struct ColumnInfo
+	{
+		// Null terminated
+		char       name[40];
+		ColumnType type;
+		uint32_t   elem_size;
+		uint32_t   elem_align;
+		// Dimensions of a stored Array, 0 for a plain column
+		uint32_t   rank;
+		uint64_t   dims[column_max_rank];
+		uint64_t   offset;
+		uint64_t   count;
+		uint32_t   crc;
+		uint32_t   reserved;
+	};
+
+	// Collects columns and writes them out in one go
+	// The data passed to add() is not copied and must stay alive until write()
+	template<typename Alloc = MallocAllocator> class ColumnWriter
+	{
+	public:
+		inline ColumnWriter();
+		inline explicit ColumnWriter(Alloc a);
+
+		// Return false if the name is empty, too long or already used, or memory could not be allocated
+		template<typename T>
+		inline bool add(const char* name, ArrayPtr<const T> column);
+		template<typename T, size_t N, size_t... NS>
+		inline bool add(const char* name, const Array<T, N, NS...>& arr);
+
+		inline size_t size() const;
+		inline void   clear();
+
+		// Return false if the file could not be written
+		inline bool write(const char* path) const;
+	private:
+		struct Source
+		{
+			ColumnInfo     info;
+			const uint8_t* data;
+		};
+
+		DynamicArray<Source, GrowDouble, Alloc> sources;
+
+		inline bool add(const char* name, ColumnInfo info, const uint8_t* data);
+	};
+
+	class ColumnFile
+	{
+	public:
+		inline ColumnFile();
+
+		// Return false if the file is missing, truncated or not a column file of this version
+		// verify_data also checks every column checksum, reading the whole file
+		inline bool open(const char* path, bool verify_data = false);
+		inline void close();
+
+		inline operator bool() const;
+
+		inline ArrayPtr<const ColumnInfo> columns() const;
+		// nullptr if there is no column of that name
+		inline const ColumnInfo* find(const char* name) const;
+
+		// View of a column. nullptr if it is missing or was written with a different element type
+		// A stored Array can also be viewed flat as its element type
+		template<typename T>
+		inline ArrayPtr<const T> column(const char* name) const;
+		// nullptr unless the column was written from an Array of the same type and dimensions
+		template<typename T, size_t N, size_t... NS>
+		inline const Array<T, N, NS...>* array(const char* name) const;
+
+		// Check column checksums. Return false on a mismatch or missing column
+		inline bool verify() const;
+		inline bool verify(const char* name) const;
+
+		inline       MappedFile& file();
+		inline const MappedFile& file() const;
+	private:
+		MappedFile                 mapped;
+		ArrayPtr<const ColumnInfo> table;
+
+		inline bool verify(const ColumnInfo& info) const;
+	};
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	constexpr const char     column_magic[8] = {'R', 'C', 'O', 'M', 'C', 'O', 'L', 0};
+	constexpr const uint32_t column_version  = 1;
+	constexpr const uint32_t column_endian   = 0x01020304;
+
+	// Reflected polynomial 0x1EDC6F41
+	struct Crc32cEntry
+	{
+		inline constexpr uint32_t operator()(size_t i) const
+		{
+			uint32_t c = static_cast<uint32_t>(i);
+
+			for(int k = 0; k < 8; ++k)
+			{
+				c = c & 1 ? (c >> 1) ^ 0x82F63B78 : c >> 1;
+			}
+			return c;
+		}
+	};
+
+	inline uint32_t crc32c_table(uint32_t crc, const uint8_t* p, size_t n)
+	{
+		static constexpr const Array<uint32_t, 256> table = generate_array<uint32_t, 256>(Crc32cEntry{});
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			crc = table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc;
+	}
+
+#if defined(RCOM_X86) && defined(__x86_64__)
+	RCOM_TARGET("sse4.2") inline uint32_t crc32c_sse42(uint32_t crc, const uint8_t* p, size_t n)
+	{
+		uint64_t c = crc;
+
+		for(; n >= 8; p += 8, n -= 8)
+		{
+			uint64_t v;
+			std::memcpy(&v, p, 8);
+			c = _mm_crc32_u64(c, v);
+		}
+
+		uint32_t c32 = static_cast<uint32_t>(c);
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			c32 = _mm_crc32_u8(c32, p[i]);
+		}
+		return c32;
+	}
+#endif
+
+	inline uint64_t align_column(uint64_t offset, uint64_t align)
+	{
+		return (offset + align - 1) / align * align;
+	}
+
+	inline bool write_all(int fd, const uint8_t* p, size_t n)
+	{
+		while(n)
+		{
+			ssize_t r = ::write(fd, p, n);
+
+			if(r < 0 && errno == EINTR)
+			{
+				continue;
+			}
+
+			if(r <= 0)
+			{
+				return false;
+			}
+
+			p += r;
+			n -= static_cast<size_t>(r);
+		}
+		return true;
+	}
+
+	inline bool write_zeros(int fd, size_t n)
+	{
+		static const uint8_t zeros[RCOM_COLUMN_ALIGN] = {};
+
+		while(n)
+		{
+			size_t step = n < sizeof(zeros) ? n : sizeof(zeros);
+
+			if(!write_all(fd, zeros, step))
+			{
+				return false;
+			}
+			n -= step;
+		}
+		return true;
+	}
+
+	inline bool column_name_equal(const ColumnInfo& info, const char* name)
+	{
+		return std::strncmp(info.name, name, sizeof(info.name)) == 0;
+	}
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	uint32_t crc32c(ArrayPtr<const uint8_t> bytes, uint32_t crc)
+	{
+		crc = ~crc;
+
+#if defined(RCOM_X86) && defined(__x86_64__)
+		if(cpu_supports(cpu_sse42))
+		{
+			return ~hidden::crc32c_sse42(crc, bytes.data(), bytes.size());
+		}
+#endif
+		return ~hidden::crc32c_table(crc, bytes.data(), bytes.size());
+	}
+
+	template<typename T> constexpr ColumnType column_type()
+	{
+		if(std::is_floating_point<T>::value)
+		{
+			return sizeof(T) == 4 ? ColumnType::float32 : sizeof(T) == 8 ? ColumnType::float64 : ColumnType::raw;
+		}
+
+		if(std::is_integral<T>::value && std::is_signed<T>::value)
+		{
+			return sizeof(T) == 1 ? ColumnType::int8 : sizeof(T) == 2 ? ColumnType::int16 : sizeof(T) == 4 ? ColumnType::int32 : ColumnType::int64;
+		}
+
+		if(std::is_integral<T>::value)
+		{
+			return sizeof(T) == 1 ? ColumnType::uint8 : sizeof(T) == 2 ? ColumnType::uint16 : sizeof(T) == 4 ? ColumnType::uint32 : ColumnType::uint64;
+		}
+
+		return ColumnType::raw;
+	}
+
+	template<typename Alloc> ColumnWriter<Alloc>::ColumnWriter() :
+		sources{}
+	{
+	}
+
+	template<typename Alloc> ColumnWriter<Alloc>::ColumnWriter(Alloc a) :
+		sources{a}
+	{
+	}
+
+	template<typename Alloc>
+	template<typename T> bool ColumnWriter<Alloc>::add(const char* name, ArrayPtr<const T> column)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Column types must be trivially copyable");
+
+		ColumnInfo info{};
+		info.type       = column_type<T>();
+		info.elem_size  = sizeof(T);
+		info.elem_align = alignof(T);
+		info.count      = column.size();
+		return add(name, info, reinterpret_cast<const uint8_t*>(column.data()));
+	}
+
+	template<typename Alloc>
+	template<typename T, size_t N, size_t... NS> bool ColumnWriter<Alloc>::add(const char* name, const Array<T, N, NS...>& arr)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Column types must be trivially copyable");
+		static_assert(1 + sizeof...(NS) <= column_max_rank, "Array has too many dimensions to store");
+
+		const size_t dims[] = {N, NS...};
+
+		ColumnInfo info{};
+		info.type       = column_type<T>();
+		info.elem_size  = sizeof(T);
+		info.elem_align = alignof(T);
+		info.rank       = 1 + sizeof...(NS);
+		info.count      = Array<T, N, NS...>::flat_size();
+
+		for(size_t i = 0; i < info.rank; ++i)
+		{
+			info.dims[i] = dims[i];
+		}
+		return add(name, info, arr.to_bytes().data());
+	}
+
+	template<typename Alloc> bool ColumnWriter<Alloc>::add(const char* name, ColumnInfo info, const uint8_t* data)
+	{
+		RCOM_ASSERT(name, "Null pointer");
+
+		size_t len = std::strlen(name);
+
+		if(len == 0 || len >= sizeof(info.name))
+		{
+			return false;
+		}
+
+		for(const Source& s : sources)
+		{
+			if(hidden::column_name_equal(s.info, name))
+			{
+				return false;
+			}
+		}
+
+		std::memcpy(info.name, name, len);
+		return sources.push(Source{info, data}) != nullptr;
+	}
+
+	template<typename Alloc> size_t ColumnWriter<Alloc>::size() const
+	{
+		return sources.size();
+	}
+
+	template<typename Alloc> void ColumnWriter<Alloc>::clear()
+	{
+		sources.clear();
+	}
+
+	template<typename Alloc> bool ColumnWriter<Alloc>::write(const char* path) const
+	{
+		RCOM_ASSERT(path, "Null pointer");
+
+		ColumnFileHeader header{};
+		std::memcpy(header.magic, hidden::column_magic, sizeof(header.magic));
+		header.version      = hidden::column_version;
+		header.endian       = hidden::column_endian;
+		header.column_count = static_cast<uint32_t>(sources.size());
+
+		// Lay out the columns and fill in their offsets and checksums
+		DynamicArray<ColumnInfo, GrowDouble, Alloc> table{sources.allocator()};
+
+		if(!table.reserve(sources.size()))
+		{
+			return false;
+		}
+
+		uint64_t end = sizeof(ColumnFileHeader) + ::byte_size<ColumnInfo>(sources.size());
+
+		for(const Source& s : sources)
+		{
+			ColumnInfo info = s.info;
+			uint64_t   size = info.count * info.elem_size;
+
+			info.offset = hidden::align_column(end, info.elem_align > RCOM_COLUMN_ALIGN ? info.elem_align : RCOM_COLUMN_ALIGN);
+			info.crc    = crc32c({s.data, static_cast<size_t>(size)});
+			end         = info.offset + size;
+			table.push(info);
+		}
+
+		header.file_size = end;
+		header.table_crc = crc32c(table.to_bytes(), crc32c({reinterpret_cast<const uint8_t*>(&header), sizeof(header)}));
+
+		int fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+		if(fd < 0)
+		{
+			return false;
+		}
+
+		RCOM_DEFER_TO_SCOPE{::close(fd);};
+
+		if(!hidden::write_all(fd, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) || !hidden::write_all(fd, table.to_bytes().data(), table.byte_size()))
+		{
+			return false;
+		}
+
+		uint64_t pos = sizeof(ColumnFileHeader) + table.byte_size();
+
+		for(size_t i = 0; i < table.size(); ++i)
+		{
+			const ColumnInfo& info = table[i];
+			size_t            size = static_cast<size_t>(info.count * info.elem_size);
+
+			if(!hidden::write_zeros(fd, static_cast<size_t>(info.offset - pos)) || !hidden::write_all(fd, sources[i].data, size))
+			{
+				return false;
+			}
+			pos = info.offset + size;
+		}
+		return true;
+	}
+
+	ColumnFile::ColumnFile() :
+		mapped{},
+		table{}
+	{
+	}
+
+	bool ColumnFile::open(const char* path, bool verify_data)
+	{
+		close();
+
+		if(!mapped.open(path))
+		{
+			return false;
+		}
+
+		ArrayPtr<const ColumnFileHeader> header = mapped.view<ColumnFileHeader>(0, 1);
+
+		bool ok = header &&
+		          std::memcmp(header[0].magic, hidden::column_magic, sizeof(header[0].magic)) == 0 &&
+		          header[0].version   == hidden::column_version &&
+		          header[0].endian    == hidden::column_endian &&
+		          header[0].file_size == mapped.size();
+
+		if(ok)
+		{
+			table = mapped.view<ColumnInfo>(sizeof(ColumnFileHeader), header[0].column_count);
+
+			ColumnFileHeader h = header[0];
+			h.table_crc        = 0;
+			ok                 = table && crc32c(table.to_bytes(), crc32c({reinterpret_cast<const uint8_t*>(&h), sizeof(h)})) == header[0].table_crc;
+		}
+
+		// Bounds are checked again when a column is viewed, only the names and ranks need checking here
+		for(size_t i = 0; ok && i < table.size(); ++i)
+		{
+			ok = table[i].name[sizeof(table[i].name) - 1] == 0 && table[i].rank <= column_max_rank;
+		}
+
+		if(!ok || (verify_data && !verify()))
+		{
+			close();
+			return false;
+		}
+		return true;
+	}
+
+	void ColumnFile::close()
+	{
+		mapped.close();
+		table = nullptr;
+	}
+
+	ColumnFile::operator bool() const
+	{
+		return mapped;
+	}
+
+	ArrayPtr<const ColumnInfo> ColumnFile::columns() const
+	{
+		return table;
+	}
+
+	const ColumnInfo* ColumnFile::find(const char* name) const
+	{
+		RCOM_ASSERT(name, "Null pointer");
+
+		for(const ColumnInfo& info : table)
+		{
+			if(hidden::column_name_equal(info, name))
+			{
+				return &info;
+			}
+		}
+		return nullptr;
+	}
+
+	template<typename T> ArrayPtr<const T> ColumnFile::column(const char* name) const
+	{
+		const ColumnInfo* info = find(name);
+
+		if(!info || info->type != column_type<T>() || info->elem_size != sizeof(T) || info->count > SIZE_MAX || info->offset > SIZE_MAX)
+		{
+			return nullptr;
+		}
+
+		// Empty columns have nothing to map but are still present
+		if(info->count == 0 && info->offset <= mapped.size())
+		{
+			return {reinterpret_cast<const T*>(mapped.to_bytes().data() + info->offset), 0};
+		}
+
+		return mapped.view<T>(static_cast<size_t>(info->offset), static_cast<size_t>(info->count));
+	}
+
+	template<typename T, size_t N, size_t... NS> const Array<T, N, NS...>* ColumnFile::array(const char* name) const
+	{
+		const size_t      dims[] = {N, NS...};
+		const ColumnInfo* info   = find(name);
+
+		if(!info || info->rank != 1 + sizeof...(NS))
+		{
+			return nullptr;
+		}
+
+		for(size_t i = 0; i < info->rank; ++i)
+		{
+			if(info->dims[i] != dims[i])
+			{
+				return nullptr;
+			}
+		}
+
+		ArrayPtr<const T> flat = column<T>(name);
+
+		if(flat.size() != Array<T, N, NS...>::flat_size())
+		{
+			return nullptr;
+		}
+
+		return reinterpret_cast<const Array<T, N, NS...>*>(flat.data());
+	}
+
+	bool ColumnFile::verify() const
+	{
+		for(const ColumnInfo& info : table)
+		{
+			if(!verify(info))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool ColumnFile::verify(const char* name) const
+	{
+		const ColumnInfo* info = find(name);
+		return info && verify(*info);
+	}
+
+	bool ColumnFile::verify(const ColumnInfo& info) const
+	{
+		uint64_t size = info.count * info.elem_size;
+
+		if(info.elem_size == 0 || info.count > mapped.size() / info.elem_size || info.offset > mapped.size() - size)
+		{
+			return false;
+		}
+
+		return crc32c({mapped.to_bytes().data() + info.offset, static_cast<size_t>(size)}) == info.crc;
+	}
+
+	MappedFile& ColumnFile::file()
+	{
+		return mapped;
+	}
+
+	const MappedFile& ColumnFile::file() const
+	{
+		return mapped;
+	}
+}
+// namespace::rcom
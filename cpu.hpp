@@ -0,0 +1,68 @@
+#pragma once
+
+// CPU feature detection for runtime dispatch
+
+#include "basic.hpp"
+
+// Define RCOM_DISABLE_SIMD to always take the scalar paths
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(RCOM_DISABLE_SIMD)
+	#define RCOM_X86 1
+	#include <immintrin.h>
+	// Compile a single function for an instruction set the rest of the program does not assume
+	#define RCOM_TARGET(x) __attribute__((target(x)))
+#else
+	#define RCOM_TARGET(x)
+#endif
+
+namespace rcom
+{
+	enum CpuFeature : uint32_t
+	{
+		cpu_sse2   = 1 << 0,
+		cpu_ssse3  = 1 << 1,
+		cpu_sse41  = 1 << 2,
+		cpu_sse42  = 1 << 3,
+		cpu_popcnt = 1 << 4,
+		cpu_avx2   = 1 << 5,
+		cpu_bmi2   = 1 << 6
+	};
+
+	// Bitmask of CpuFeature. Detected once
+	inline uint32_t cpu_features()
+	{
+#if defined(RCOM_X86)
+		static const uint32_t features = []()
+		{
+			__builtin_cpu_init();
+
+			uint32_t f = 0;
+			if(__builtin_cpu_supports("sse2"))    f |= cpu_sse2;
+			if(__builtin_cpu_supports("ssse3"))   f |= cpu_ssse3;
+			if(__builtin_cpu_supports("sse4.1"))  f |= cpu_sse41;
+			if(__builtin_cpu_supports("sse4.2"))  f |= cpu_sse42;
+			if(__builtin_cpu_supports("popcnt"))  f |= cpu_popcnt;
+			if(__builtin_cpu_supports("avx2"))    f |= cpu_avx2;
+			if(__builtin_cpu_supports("bmi2"))    f |= cpu_bmi2;
+			return f;
+		}();
+		return features;
+#else
+		return 0;
+#endif
+	}
+
+	// True if every feature in the mask is available
+	inline bool cpu_supports(uint32_t features)
+	{
+		return (cpu_features() & features) == features;
+	}
+
+	// Hint that the caller is spinning on memory another core will write
+	inline void cpu_relax()
+	{
+#if defined(RCOM_X86)
+		_mm_pause();
+#endif
+	}
+}
+// namespace::rcom
@@ -0,0 +1,426 @@
+#pragma once
+
+#include "allocator.hpp"
+
+namespace rcom
+{
+	// Growth policies
+	// grow() returns the new capacity given the current capacity and the number of elements required
+
+	// Double the capacity
+	struct GrowDouble
+	{
+		inline static size_t grow(size_t capacity, size_t required);
+	};
+
+	// Grow the capacity by 1.5x. Lets freed blocks be reused by later allocations
+	struct GrowOneAndHalf
+	{
+		inline static size_t grow(size_t capacity, size_t required);
+	};
+
+	// Grow the capacity by a fixed number of elements
+	template<size_t Step> struct GrowStep
+	{
+		static_assert(Step > 0, "Growth step must be non zero");
+
+		inline static size_t grow(size_t capacity, size_t required);
+	};
+
+	size_t GrowDouble::grow(size_t capacity, size_t required)
+	{
+		size_t n = capacity ? capacity * 2 : 8;
+		return n > required ? n : required;
+	}
+
+	size_t GrowOneAndHalf::grow(size_t capacity, size_t required)
+	{
+		size_t n = capacity ? capacity + (capacity + 1) / 2 : 8;
+		return n > required ? n : required;
+	}
+
+	template<size_t Step> size_t GrowStep<Step>::grow(size_t capacity, size_t required)
+	{
+		size_t n = capacity + Step;
+		return n > required ? n : required;
+	}
+
+	// Array with a counted logical size which is less than or equal to the capacity of the underlying array
+	template<typename T, typename Growth = GrowDouble, typename Alloc = MallocAllocator> class DynamicArray
+	{
+	public:
+		inline DynamicArray();
+		inline explicit DynamicArray(Alloc a);
+		inline DynamicArray(DynamicArray&& other);
+		inline DynamicArray& operator=(DynamicArray&& other);
+		inline ~DynamicArray();
+
+		DynamicArray(const DynamicArray&)            = delete;
+		DynamicArray& operator=(const DynamicArray&) = delete;
+
+		inline size_t size()      const;
+		inline size_t capacity()  const;
+		inline size_t byte_size() const;
+
+		inline       Alloc& allocator();
+		inline const Alloc& allocator() const;
+
+		inline ArrayPtr<T>             to_ptr();
+		inline ArrayPtr<const T>       to_ptr() const;
+		inline BytePtr                 to_bytes();
+		inline ArrayPtr<const uint8_t> to_bytes() const;
+
+		inline ArrayPtr<const T> slice(size_t start, size_t end) const;
+		inline ArrayPtr<T>       slice(size_t start, size_t end);
+		inline ArrayPtr<const T> slice(size_t start) const;
+		inline ArrayPtr<T>       slice(size_t start);
+
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start, size_t end) const;
+		inline BytePtr                 byte_slice(size_t start, size_t end);
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start) const;
+		inline BytePtr                 byte_slice(size_t start);
+
+		inline       T&  operator[](size_t i);
+		inline const T&  operator[](size_t i)  const;
+
+		inline       T*  data();
+		inline const T*  data()  const;
+		inline       T*  begin();
+		inline const T*  begin() const;
+		inline       T*  end();
+		inline const T*  end()   const;
+		inline       T&  first();
+		inline const T&  first() const;
+		inline       T&  last();
+		inline const T&  last()  const;
+
+		// Return nullptr if memory could not be allocated
+		inline T* push(const T& value);
+		inline T* push(T&& value);
+		template<typename... Args>
+		inline T* emplace(Args&&... args);
+		inline void pop();
+
+		// Return false if memory could not be allocated
+		inline bool reserve(size_t n);
+		inline bool resize(size_t n);
+		inline void clear();
+	private:
+		ArrayPtr<T> buffer;
+		size_t      count;
+		Alloc       alloc;
+
+		inline bool grow(size_t required);
+		inline bool set_capacity(size_t n);
+		inline void release();
+	};
+
+	template<typename T, typename Growth, typename Alloc> DynamicArray<T, Growth, Alloc>::DynamicArray() :
+		buffer{},
+		count{0},
+		alloc{}
+	{
+	}
+
+	template<typename T, typename Growth, typename Alloc> DynamicArray<T, Growth, Alloc>::DynamicArray(Alloc a) :
+		buffer{},
+		count{0},
+		alloc{a}
+	{
+	}
+
+	template<typename T, typename Growth, typename Alloc> DynamicArray<T, Growth, Alloc>::DynamicArray(DynamicArray&& other) :
+		buffer{other.buffer},
+		count{other.count},
+		alloc{other.alloc}
+	{
+		other.buffer = nullptr;
+		other.count  = 0;
+	}
+
+	template<typename T, typename Growth, typename Alloc> auto DynamicArray<T, Growth, Alloc>::operator=(DynamicArray&& other) -> DynamicArray&
+	{
+		if(this != &other)
+		{
+			release();
+			buffer       = other.buffer;
+			count        = other.count;
+			alloc        = other.alloc;
+			other.buffer = nullptr;
+			other.count  = 0;
+		}
+		return *this;
+	}
+
+	template<typename T, typename Growth, typename Alloc> DynamicArray<T, Growth, Alloc>::~DynamicArray()
+	{
+		release();
+	}
+
+	template<typename T, typename Growth, typename Alloc> void DynamicArray<T, Growth, Alloc>::release()
+	{
+		hidden::destroy(buffer.data(), count);
+		deallocate_array(alloc, buffer);
+		buffer = nullptr;
+		count  = 0;
+	}
+
+	template<typename T, typename Growth, typename Alloc> bool DynamicArray<T, Growth, Alloc>::grow(size_t required)
+	{
+		return set_capacity(Growth::grow(buffer.size(), required));
+	}
+
+	template<typename T, typename Growth, typename Alloc> bool DynamicArray<T, Growth, Alloc>::set_capacity(size_t n)
+	{
+		if(is_trivially_relocatable<T>::value)
+		{
+			// Let the allocator move the block, possibly without copying
+			BytePtr mem = alloc.reallocate(buffer.to_bytes(), ::byte_size<T>(n), alignof(T));
+
+			if(!mem)
+			{
+				return false;
+			}
+
+			buffer = {reinterpret_cast<T*>(mem.data()), n};
+			return true;
+		}
+
+		ArrayPtr<T> mem = allocate_array<T>(alloc, n);
+
+		if(!mem)
+		{
+			return false;
+		}
+
+		hidden::relocate(mem.data(), buffer.data(), count);
+		deallocate_array(alloc, buffer);
+		buffer = mem;
+		return true;
+	}
+
+	template<typename T, typename Growth, typename Alloc> bool DynamicArray<T, Growth, Alloc>::reserve(size_t n)
+	{
+		return n <= buffer.size() || set_capacity(n);
+	}
+
+	template<typename T, typename Growth, typename Alloc> bool DynamicArray<T, Growth, Alloc>::resize(size_t n)
+	{
+		if(n > buffer.size() && !grow(n))
+		{
+			return false;
+		}
+
+		for(size_t i = count; i < n; ++i)
+		{
+			new(&buffer.data()[i]) T();
+		}
+
+		if(n < count)
+		{
+			hidden::destroy(&buffer.data()[n], count - n);
+		}
+
+		count = n;
+		return true;
+	}
+
+	template<typename T, typename Growth, typename Alloc> void DynamicArray<T, Growth, Alloc>::clear()
+	{
+		hidden::destroy(buffer.data(), count);
+		count = 0;
+	}
+
+	template<typename T, typename Growth, typename Alloc> T* DynamicArray<T, Growth, Alloc>::push(const T& value)
+	{
+		if(count == buffer.size())
+		{
+			// value may refer to an element which is about to be moved
+			T copy(value);
+			return emplace(std::move(copy));
+		}
+		return emplace(value);
+	}
+
+	template<typename T, typename Growth, typename Alloc> T* DynamicArray<T, Growth, Alloc>::push(T&& value)
+	{
+		return emplace(std::move(value));
+	}
+
+	template<typename T, typename Growth, typename Alloc>
+	template<typename... Args> T* DynamicArray<T, Growth, Alloc>::emplace(Args&&... args)
+	{
+		if(count == buffer.size() && !grow(count + 1))
+		{
+			return nullptr;
+		}
+
+		T* t = new(&buffer.data()[count]) T(std::forward<Args>(args)...);
+		++count;
+		return t;
+	}
+
+	template<typename T, typename Growth, typename Alloc> void DynamicArray<T, Growth, Alloc>::pop()
+	{
+		RCOM_ASSERT(count > 0, "Pop from empty array");
+
+		--count;
+		buffer.data()[count].~T();
+	}
+
+	template<typename T, typename Growth, typename Alloc> size_t DynamicArray<T, Growth, Alloc>::size() const
+	{
+		return count;
+	}
+
+	template<typename T, typename Growth, typename Alloc> size_t DynamicArray<T, Growth, Alloc>::capacity() const
+	{
+		return buffer.size();
+	}
+
+	template<typename T, typename Growth, typename Alloc> size_t DynamicArray<T, Growth, Alloc>::byte_size() const
+	{
+		return ::byte_size<T>(count);
+	}
+
+	template<typename T, typename Growth, typename Alloc> Alloc& DynamicArray<T, Growth, Alloc>::allocator()
+	{
+		return alloc;
+	}
+
+	template<typename T, typename Growth, typename Alloc> const Alloc& DynamicArray<T, Growth, Alloc>::allocator() const
+	{
+		return alloc;
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<T> DynamicArray<T, Growth, Alloc>::to_ptr()
+	{
+		return {buffer.data(), count};
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<const T> DynamicArray<T, Growth, Alloc>::to_ptr() const
+	{
+		return {buffer.data(), count};
+	}
+
+	template<typename T, typename Growth, typename Alloc> BytePtr DynamicArray<T, Growth, Alloc>::to_bytes()
+	{
+		return to_ptr().to_bytes();
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<const uint8_t> DynamicArray<T, Growth, Alloc>::to_bytes() const
+	{
+		ArrayPtr<const T> p = to_ptr();
+
+		return {reinterpret_cast<const uint8_t*>(p.data()), p.byte_size()};
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<const T> DynamicArray<T, Growth, Alloc>::slice(size_t start, size_t end) const
+	{
+		return to_ptr().slice(start, end);
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<T> DynamicArray<T, Growth, Alloc>::slice(size_t start, size_t end)
+	{
+		return to_ptr().slice(start, end);
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<const T> DynamicArray<T, Growth, Alloc>::slice(size_t start) const
+	{
+		return to_ptr().slice(start);
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<T> DynamicArray<T, Growth, Alloc>::slice(size_t start)
+	{
+		return to_ptr().slice(start);
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<const uint8_t> DynamicArray<T, Growth, Alloc>::byte_slice(size_t start, size_t end) const
+	{
+		ArrayPtr<const T> p = slice(start, end);
+
+		return {reinterpret_cast<const uint8_t*>(p.data()), p.byte_size()};
+	}
+
+	template<typename T, typename Growth, typename Alloc> BytePtr DynamicArray<T, Growth, Alloc>::byte_slice(size_t start, size_t end)
+	{
+		return to_ptr().byte_slice(start, end);
+	}
+
+	template<typename T, typename Growth, typename Alloc> ArrayPtr<const uint8_t> DynamicArray<T, Growth, Alloc>::byte_slice(size_t start) const
+	{
+		return byte_slice(start, count);
+	}
+
+	template<typename T, typename Growth, typename Alloc> BytePtr DynamicArray<T, Growth, Alloc>::byte_slice(size_t start)
+	{
+		return to_ptr().byte_slice(start);
+	}
+
+	template<typename T, typename Growth, typename Alloc> T& DynamicArray<T, Growth, Alloc>::operator[](size_t i)
+	{
+		RCOM_ASSERT(i < count, "Index out of range");
+		return buffer.data()[i];
+	}
+
+	template<typename T, typename Growth, typename Alloc> const T& DynamicArray<T, Growth, Alloc>::operator[](size_t i) const
+	{
+		RCOM_ASSERT(i < count, "Index out of range");
+		return buffer.data()[i];
+	}
+
+	template<typename T, typename Growth, typename Alloc> T* DynamicArray<T, Growth, Alloc>::data()
+	{
+		return buffer.data();
+	}
+
+	template<typename T, typename Growth, typename Alloc> const T* DynamicArray<T, Growth, Alloc>::data() const
+	{
+		return buffer.data();
+	}
+
+	template<typename T, typename Growth, typename Alloc> T* DynamicArray<T, Growth, Alloc>::begin()
+	{
+		return buffer.data();
+	}
+
+	template<typename T, typename Growth, typename Alloc> const T* DynamicArray<T, Growth, Alloc>::begin() const
+	{
+		return buffer.data();
+	}
+
+	template<typename T, typename Growth, typename Alloc> T* DynamicArray<T, Growth, Alloc>::end()
+	{
+		return buffer.data() + count;
+	}
+
+	template<typename T, typename Growth, typename Alloc> const T* DynamicArray<T, Growth, Alloc>::end() const
+	{
+		return buffer.data() + count;
+	}
+
+	template<typename T, typename Growth, typename Alloc> T& DynamicArray<T, Growth, Alloc>::first()
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[0];
+	}
+
+	template<typename T, typename Growth, typename Alloc> const T& DynamicArray<T, Growth, Alloc>::first() const
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[0];
+	}
+
+	template<typename T, typename Growth, typename Alloc> T& DynamicArray<T, Growth, Alloc>::last()
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[count - 1];
+	}
+
+	template<typename T, typename Growth, typename Alloc> const T& DynamicArray<T, Growth, Alloc>::last() const
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[count - 1];
+	}
+}
+// namespace::rcom
@@ -0,0 +1,188 @@
+#pragma once
+
+// Sorted search over the Eytzinger (breadth first) layout of static data
+//
+// The children of slot k are slots 2k and 2k + 1, so every level of the search lies in one contiguous run and the
+// next few levels under a slot share a cache line, which can be prefetched before it is needed.
+// Searches do not branch on comparisons, so they cost no mispredictions.
+// Slot 0 is unused, so a layout of n elements takes n + 1 slots. Align the layout to a cache line for those lines to line up.
+
+#include "array_ptr.hpp"
+#include <utility>
+
+namespace rcom
+{
+	template<typename T> class EytzingerIndex
+	{
+	public:
+		inline EytzingerIndex();
+		// layout must come from eytzinger_permute
+		inline explicit EytzingerIndex(ArrayPtr<const T> layout);
+
+		// Number of elements, one less than the slots in the layout
+		inline size_t size() const;
+
+		inline const T& operator[](size_t slot) const;
+
+		// Slot of the first element not less than x, 0 if every element is less
+		inline size_t lower_bound(const T& x) const;
+		inline bool   contains(const T& x)    const;
+
+		// out[i] = lower_bound(queries[i]). Searches several queries in lockstep so their cache misses overlap
+		inline void   lower_bound(ArrayPtr<const T> queries, ArrayPtr<size_t> out) const;
+	private:
+		ArrayPtr<const T> layout;
+		size_t            n;
+
+		// Slots of the same level reached by a line of descendants
+		constexpr static const size_t prefetch_stride = sizeof(T) < RCOM_CACHE_LINE_SIZE ? RCOM_CACHE_LINE_SIZE / sizeof(T) : 1;
+
+		inline void   prefetch(size_t k) const;
+		inline static size_t finish(size_t k);
+	};
+
+	namespace hidden
+	{
+		template<typename T> inline size_t eytzinger_fill(T* dst, const T* sorted, size_t n, size_t i, size_t k)
+		{
+			// In order walk of the implicit tree hands out the sorted elements in order
+			if(k <= n)
+			{
+				i      = eytzinger_fill(dst, sorted, n, i, 2 * k);
+				dst[k] = sorted[i++];
+				i      = eytzinger_fill(dst, sorted, n, i, 2 * k + 1);
+			}
+			return i;
+		}
+	}
+	// namespace hidden
+
+	// Slots needed for the layout of n elements
+	inline constexpr size_t eytzinger_size(size_t n)
+	{
+		return n + 1;
+	}
+
+	// Copy sorted into the Eytzinger layout. dst must hold eytzinger_size(sorted.size()) elements and dst[0] is left alone
+	// Permute values stored alongside the keys with the same call, they end up in the slots lower_bound returns
+	template<typename T> inline void eytzinger_permute(ArrayPtr<T> dst, ArrayPtr<const typename Identity<T>::type> sorted)
+	{
+		RCOM_ASSERT(dst.size() == eytzinger_size(sorted.size()), "Layout size does not match");
+
+		hidden::eytzinger_fill(dst.data(), sorted.data(), sorted.size(), 0, 1);
+	}
+
+	template<typename T> EytzingerIndex<T>::EytzingerIndex() :
+		layout{},
+		n{0}
+	{
+	}
+
+	template<typename T> EytzingerIndex<T>::EytzingerIndex(ArrayPtr<const T> layout) :
+		layout{layout},
+		n{layout.size() ? layout.size() - 1 : 0}
+	{
+	}
+
+	template<typename T> size_t EytzingerIndex<T>::size() const
+	{
+		return n;
+	}
+
+	template<typename T> const T& EytzingerIndex<T>::operator[](size_t slot) const
+	{
+		RCOM_ASSERT(slot >= 1 && slot <= n, "Index out of range");
+
+		return layout.data()[slot];
+	}
+
+	template<typename T> void EytzingerIndex<T>::prefetch(size_t k) const
+	{
+#if defined(__GNUC__)
+		// Descendants log2(prefetch_stride) levels down. Only a hint, so running past the end is harmless
+		__builtin_prefetch(layout.data() + k * prefetch_stride);
+#else
+		(void)k;
+#endif
+	}
+
+	template<typename T> size_t EytzingerIndex<T>::finish(size_t k)
+	{
+		// Undo the right turns taken after the last left turn, which was at the answer
+#if defined(__GNUC__)
+		return k >> __builtin_ffsll(static_cast<long long>(~k));
+#else
+		while(k & 1)
+		{
+			k >>= 1;
+		}
+		return k >> 1;
+#endif
+	}
+
+	template<typename T> size_t EytzingerIndex<T>::lower_bound(const T& x) const
+	{
+		const T* a = layout.data();
+		size_t   k = 1;
+
+		while(k <= n)
+		{
+			prefetch(k);
+			k = 2 * k + static_cast<size_t>(a[k] < x);
+		}
+		return finish(k);
+	}
+
+	template<typename T> bool EytzingerIndex<T>::contains(const T& x) const
+	{
+		size_t k = lower_bound(x);
+		return k && !(x < layout.data()[k]);
+	}
+
+	template<typename T> void EytzingerIndex<T>::lower_bound(ArrayPtr<const T> queries, ArrayPtr<size_t> out) const
+	{
+		RCOM_ASSERT(out.size() >= queries.size(), "Array too small");
+
+		const size_t batch = 8;
+		const T*     a     = layout.data();
+		const T*     q     = queries.data();
+		size_t       i     = 0;
+
+		for(; i + batch <= queries.size(); i += batch)
+		{
+			size_t k[batch];
+
+			for(size_t j = 0; j < batch; ++j)
+			{
+				k[j] = 1;
+			}
+
+			// Searches end within one level of each other, so few rounds have idle lanes
+			for(bool active = n != 0; active;)
+			{
+				active = false;
+
+				for(size_t j = 0; j < batch; ++j)
+				{
+					if(k[j] <= n)
+					{
+						prefetch(k[j]);
+						k[j]   = 2 * k[j] + static_cast<size_t>(a[k[j]] < q[i + j]);
+						active = true;
+					}
+				}
+			}
+
+			for(size_t j = 0; j < batch; ++j)
+			{
+				out.data()[i + j] = finish(k[j]);
+			}
+		}
+
+		for(; i < queries.size(); ++i)
+		{
+			out.data()[i] = lower_bound(q[i]);
+		}
+	}
+}
+// namespace::rcom
@@ -0,0 +1,791 @@
+#pragma once
+
+// Open addressing hash map and set with control bytes probed 16 at a time
+//
+// Each slot has a control byte holding 7 bits of its hash, or empty. A lookup compares a whole group of control bytes
+// against the hash bits at once and only looks at the keys that match, so most misses never touch a slot.
+// Probing is linear, which lets erase shift later elements back instead of leaving tombstones behind.
+// Control bytes and slots share one allocation from the allocator hook.
+
+#include "allocator.hpp"
+#include "cpu.hpp"
+#include <cstring>
+#include <functional>
+
+namespace rcom
+{
+	// Default hash. Mixes std::hash so identity hashes of integers spread over the table
+	struct FlatHash
+	{
+		template<typename K> inline size_t operator()(const K& key) const
+		{
+			uint64_t h = static_cast<uint64_t>(std::hash<K>{}(key));
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdULL;
+			h ^= h >> 33;
+			return static_cast<size_t>(h);
+		}
+	};
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	constexpr static const uint8_t flat_empty      = 0x80;
+	constexpr static const size_t  flat_group_size = 16;
+	constexpr static const size_t  flat_npos       = SIZE_MAX;
+
+	inline uint32_t flat_lowest_bit(uint32_t mask)
+	{
+#if defined(__GNUC__)
+		return static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+		uint32_t i = 0;
+
+		while(!(mask & 1))
+		{
+			mask >>= 1;
+			++i;
+		}
+		return i;
+#endif
+	}
+
+	// 16 control bytes, matched as bitmasks with bit i set for byte i
+	struct FlatGroup
+	{
+#if defined(RCOM_X86) && defined(__SSE2__)
+		__m128i ctrl;
+
+		explicit FlatGroup(const uint8_t* p) :
+			ctrl{_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))}
+		{
+		}
+
+		uint32_t match(uint8_t h2) const
+		{
+			return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(h2)))));
+		}
+
+		// Empty is the only control byte with the top bit set
+		uint32_t match_empty() const
+		{
+			return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+		}
+#else
+		const uint8_t* ctrl;
+
+		explicit FlatGroup(const uint8_t* p) :
+			ctrl{p}
+		{
+		}
+
+		uint32_t match(uint8_t h2) const
+		{
+			uint32_t mask = 0;
+
+			for(uint32_t i = 0; i < flat_group_size; ++i)
+			{
+				mask |= static_cast<uint32_t>(ctrl[i] == h2) << i;
+			}
+			return mask;
+		}
+
+		uint32_t match_empty() const
+		{
+			return match(flat_empty);
+		}
+#endif
+	};
+
+	template<typename K, typename V> struct FlatMapSlot
+	{
+		K key;
+		V value;
+	};
+
+	template<typename K> struct FlatSetSlot
+	{
+		K key;
+
+		// Lets set iterators hand out the key itself
+		operator const K&() const
+		{
+			return key;
+		}
+	};
+
+	// Slots and control bytes shared by FlatHashMap and FlatHashSet. Slot must have a key member
+	// The first 15 control bytes are repeated after the last so a group can be loaded at any position without wrapping
+	template<typename Slot, typename Hash, typename Alloc> class FlatTable
+	{
+	public:
+		using Key = decltype(Slot::key);
+
+		inline FlatTable();
+		inline explicit FlatTable(Alloc a);
+		inline FlatTable(FlatTable&& other);
+		inline FlatTable& operator=(FlatTable&& other);
+		inline ~FlatTable();
+
+		FlatTable(const FlatTable&)            = delete;
+		FlatTable& operator=(const FlatTable&) = delete;
+
+		inline size_t size()     const;
+		inline size_t capacity() const;
+
+		inline       Alloc& allocator();
+		inline const Alloc& allocator() const;
+
+		// Index of the slot holding key, flat_npos if absent
+		inline size_t find(const Key& key) const;
+
+		// Index of the slot holding key, or of a newly claimed slot the caller must construct. flat_npos if out of memory
+		inline size_t claim(const Key& key, bool& found);
+
+		inline bool erase(const Key& key);
+		inline bool reserve(size_t n);
+		inline void clear();
+
+		inline       Slot& slot(size_t i);
+		inline const Slot& slot(size_t i) const;
+		inline bool        full(size_t i) const;
+	private:
+		ArrayPtr<Slot>    slots;
+		ArrayPtr<uint8_t> ctrl;
+		size_t            count;
+		Alloc             alloc;
+		Hash              hash;
+
+		inline static size_t max_load(size_t capacity);
+		inline void          set_ctrl(size_t i, uint8_t c);
+		inline size_t        find_empty(size_t h) const;
+		inline bool          rehash(size_t capacity);
+		inline void          release();
+	};
+
+	template<typename Slot, typename Hash, typename Alloc> FlatTable<Slot, Hash, Alloc>::FlatTable() :
+		slots{},
+		ctrl{},
+		count{0},
+		alloc{},
+		hash{}
+	{
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> FlatTable<Slot, Hash, Alloc>::FlatTable(Alloc a) :
+		slots{},
+		ctrl{},
+		count{0},
+		alloc{a},
+		hash{}
+	{
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> FlatTable<Slot, Hash, Alloc>::FlatTable(FlatTable&& other) :
+		slots{other.slots},
+		ctrl{other.ctrl},
+		count{other.count},
+		alloc{other.alloc},
+		hash{other.hash}
+	{
+		other.slots = nullptr;
+		other.ctrl  = nullptr;
+		other.count = 0;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> auto FlatTable<Slot, Hash, Alloc>::operator=(FlatTable&& other) -> FlatTable&
+	{
+		if(this != &other)
+		{
+			release();
+
+			slots = other.slots;
+			ctrl  = other.ctrl;
+			count = other.count;
+			alloc = other.alloc;
+			hash  = other.hash;
+
+			other.slots = nullptr;
+			other.ctrl  = nullptr;
+			other.count = 0;
+		}
+		return *this;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> FlatTable<Slot, Hash, Alloc>::~FlatTable()
+	{
+		release();
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> size_t FlatTable<Slot, Hash, Alloc>::size() const
+	{
+		return count;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> size_t FlatTable<Slot, Hash, Alloc>::capacity() const
+	{
+		return slots.size();
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> Alloc& FlatTable<Slot, Hash, Alloc>::allocator()
+	{
+		return alloc;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> const Alloc& FlatTable<Slot, Hash, Alloc>::allocator() const
+	{
+		return alloc;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> Slot& FlatTable<Slot, Hash, Alloc>::slot(size_t i)
+	{
+		return slots.data()[i];
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> const Slot& FlatTable<Slot, Hash, Alloc>::slot(size_t i) const
+	{
+		return slots.data()[i];
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> bool FlatTable<Slot, Hash, Alloc>::full(size_t i) const
+	{
+		return ctrl.data()[i] != flat_empty;
+	}
+
+	// Keep at least one in eight slots empty so probes stay short and always end
+	template<typename Slot, typename Hash, typename Alloc> size_t FlatTable<Slot, Hash, Alloc>::max_load(size_t capacity)
+	{
+		return capacity - capacity / 8;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> void FlatTable<Slot, Hash, Alloc>::set_ctrl(size_t i, uint8_t c)
+	{
+		ctrl.data()[i] = c;
+
+		if(i < flat_group_size - 1)
+		{
+			ctrl.data()[slots.size() + i] = c;
+		}
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> size_t FlatTable<Slot, Hash, Alloc>::find(const Key& key) const
+	{
+		if(count == 0)
+		{
+			return flat_npos;
+		}
+
+		size_t  h    = hash(key);
+		size_t  mask = slots.size() - 1;
+		uint8_t h2   = static_cast<uint8_t>(h & 0x7f);
+
+		for(size_t pos = (h >> 7) & mask;; pos = (pos + flat_group_size) & mask)
+		{
+			FlatGroup g{ctrl.data() + pos};
+
+			for(uint32_t m = g.match(h2); m; m &= m - 1)
+			{
+				size_t i = (pos + flat_lowest_bit(m)) & mask;
+
+				if(slots.data()[i].key == key)
+				{
+					return i;
+				}
+			}
+
+			// Every element sits before the first empty slot after its home
+			if(g.match_empty())
+			{
+				return flat_npos;
+			}
+		}
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> size_t FlatTable<Slot, Hash, Alloc>::find_empty(size_t h) const
+	{
+		size_t mask = slots.size() - 1;
+
+		for(size_t pos = (h >> 7) & mask;; pos = (pos + flat_group_size) & mask)
+		{
+			uint32_t m = FlatGroup{ctrl.data() + pos}.match_empty();
+
+			if(m)
+			{
+				return (pos + flat_lowest_bit(m)) & mask;
+			}
+		}
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> size_t FlatTable<Slot, Hash, Alloc>::claim(const Key& key, bool& found)
+	{
+		size_t i = find(key);
+		found    = i != flat_npos;
+
+		if(found)
+		{
+			return i;
+		}
+
+		if(count + 1 > max_load(slots.size()))
+		{
+			size_t n = slots.size() ? slots.size() * 2 : flat_group_size;
+
+			if(!rehash(n))
+			{
+				return flat_npos;
+			}
+		}
+
+		size_t h = hash(key);
+		i        = find_empty(h);
+
+		set_ctrl(i, static_cast<uint8_t>(h & 0x7f));
+		++count;
+		return i;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> bool FlatTable<Slot, Hash, Alloc>::erase(const Key& key)
+	{
+		size_t i = find(key);
+
+		if(i == flat_npos)
+		{
+			return false;
+		}
+
+		size_t mask = slots.size() - 1;
+
+		slots.data()[i].~Slot();
+		set_ctrl(i, flat_empty);
+		--count;
+
+		// Pull back later elements of the run whose home is at or before the hole, so no lookup stops early
+		for(size_t j = (i + 1) & mask; full(j); j = (j + 1) & mask)
+		{
+			size_t home = (hash(slots.data()[j].key) >> 7) & mask;
+
+			if(((j - home) & mask) >= ((j - i) & mask))
+			{
+				relocate(&slots.data()[i], &slots.data()[j], 1);
+				set_ctrl(i, ctrl.data()[j]);
+				set_ctrl(j, flat_empty);
+				i = j;
+			}
+		}
+		return true;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> bool FlatTable<Slot, Hash, Alloc>::reserve(size_t n)
+	{
+		size_t capacity = slots.size() ? slots.size() : flat_group_size;
+
+		while(max_load(capacity) < n)
+		{
+			capacity *= 2;
+		}
+
+		return capacity <= slots.size() || rehash(capacity);
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> void FlatTable<Slot, Hash, Alloc>::clear()
+	{
+		for(size_t i = 0; i < slots.size(); ++i)
+		{
+			if(full(i))
+			{
+				slots.data()[i].~Slot();
+			}
+		}
+
+		if(ctrl)
+		{
+			memset(ctrl.data(), flat_empty, ctrl.size());
+		}
+
+		count = 0;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> bool FlatTable<Slot, Hash, Alloc>::rehash(size_t capacity)
+	{
+		RCOM_ASSERT((capacity & (capacity - 1)) == 0 && capacity >= flat_group_size, "Capacity must be a power of two of at least a group");
+
+		// Slots first, control bytes after them
+		size_t  align = alignof(Slot) > flat_group_size ? alignof(Slot) : flat_group_size;
+		size_t  bytes = ::byte_size<Slot>(capacity) + capacity + flat_group_size;
+		BytePtr mem   = alloc.allocate(bytes, align);
+
+		if(!mem)
+		{
+			return false;
+		}
+
+		ArrayPtr<Slot>    old_slots = slots;
+		ArrayPtr<uint8_t> old_ctrl  = ctrl;
+
+		slots = {reinterpret_cast<Slot*>(mem.data()), capacity};
+		ctrl  = {mem.data() + ::byte_size<Slot>(capacity), capacity + flat_group_size};
+		memset(ctrl.data(), flat_empty, ctrl.size());
+
+		for(size_t i = 0; i < old_slots.size(); ++i)
+		{
+			if(old_ctrl.data()[i] != flat_empty)
+			{
+				size_t j = find_empty(hash(old_slots.data()[i].key));
+				relocate(&slots.data()[j], &old_slots.data()[i], 1);
+				set_ctrl(j, old_ctrl.data()[i]);
+			}
+		}
+
+		if(old_slots)
+		{
+			alloc.deallocate({reinterpret_cast<uint8_t*>(old_slots.data()), ::byte_size<Slot>(old_slots.size()) + old_ctrl.size()}, align);
+		}
+		return true;
+	}
+
+	template<typename Slot, typename Hash, typename Alloc> void FlatTable<Slot, Hash, Alloc>::release()
+	{
+		if(slots)
+		{
+			clear();
+
+			size_t align = alignof(Slot) > flat_group_size ? alignof(Slot) : flat_group_size;
+			alloc.deallocate({reinterpret_cast<uint8_t*>(slots.data()), ::byte_size<Slot>(slots.size()) + ctrl.size()}, align);
+
+			slots = nullptr;
+			ctrl  = nullptr;
+		}
+	}
+
+	// Walks the full slots of a table
+	template<typename Table, typename Ref> class FlatIterator
+	{
+	public:
+		FlatIterator(Table* t, size_t i) :
+			table{t},
+			index{i}
+		{
+			skip();
+		}
+
+		Ref operator*() const
+		{
+			return Ref(table->slot(index));
+		}
+
+		FlatIterator& operator++()
+		{
+			++index;
+			skip();
+			return *this;
+		}
+
+		bool operator!=(const FlatIterator& other) const
+		{
+			return index != other.index;
+		}
+	private:
+		Table* table;
+		size_t index;
+
+		void skip()
+		{
+			while(index < table->capacity() && !table->full(index))
+			{
+				++index;
+			}
+		}
+	};
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	// Hash map of K to V. Keys are compared with operator==
+	// Inserting or erasing moves other elements, so pointers returned by find and insert only last until the next change
+	template<typename K, typename V, typename Hash = FlatHash, typename Alloc = MallocAllocator> class FlatHashMap
+	{
+	public:
+		using Slot = hidden::FlatMapSlot<K, V>;
+
+		inline FlatHashMap();
+		inline explicit FlatHashMap(Alloc a);
+		FlatHashMap(FlatHashMap&&)            = default;
+		FlatHashMap& operator=(FlatHashMap&&) = default;
+
+		inline size_t size()     const;
+		inline size_t capacity() const;
+		inline bool   empty()    const;
+
+		inline       Alloc& allocator();
+		inline const Alloc& allocator() const;
+
+		// Return nullptr if the key is absent
+		inline       V* find(const K& key);
+		inline const V* find(const K& key) const;
+		inline bool     contains(const K& key) const;
+
+		// Construct the value from args if the key is absent. Return the value either way, nullptr if memory could not be allocated
+		template<typename... Args>
+		inline V* emplace(const K& key, Args&&... args);
+		inline V* insert(const K& key, const V& value);
+		inline V* insert(const K& key, V&& value);
+
+		// Return false if the key was absent
+		inline bool erase(const K& key);
+
+		// Make room for n elements without growing. Return false if memory could not be allocated
+		inline bool reserve(size_t n);
+		inline void clear();
+
+		// Iterates Slots with key and value members. Do not change the keys
+		inline hidden::FlatIterator<hidden::FlatTable<Slot, Hash, Alloc>,             Slot&>       begin();
+		inline hidden::FlatIterator<hidden::FlatTable<Slot, Hash, Alloc>,             Slot&>       end();
+		inline hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const Slot&> begin() const;
+		inline hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const Slot&> end()   const;
+	private:
+		hidden::FlatTable<Slot, Hash, Alloc> table;
+	};
+
+	// Hash set of K. Keys are compared with operator==
+	template<typename K, typename Hash = FlatHash, typename Alloc = MallocAllocator> class FlatHashSet
+	{
+	public:
+		using Slot = hidden::FlatSetSlot<K>;
+
+		inline FlatHashSet();
+		inline explicit FlatHashSet(Alloc a);
+		FlatHashSet(FlatHashSet&&)            = default;
+		FlatHashSet& operator=(FlatHashSet&&) = default;
+
+		inline size_t size()     const;
+		inline size_t capacity() const;
+		inline bool   empty()    const;
+
+		inline       Alloc& allocator();
+		inline const Alloc& allocator() const;
+
+		inline bool contains(const K& key) const;
+
+		// Return the key in the set, nullptr if memory could not be allocated
+		inline const K* insert(const K& key);
+
+		// Return false if the key was absent
+		inline bool erase(const K& key);
+
+		inline bool reserve(size_t n);
+		inline void clear();
+
+		inline hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const K&> begin() const;
+		inline hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const K&> end()   const;
+	private:
+		hidden::FlatTable<Slot, Hash, Alloc> table;
+	};
+
+	template<typename K, typename V, typename Hash, typename Alloc> FlatHashMap<K, V, Hash, Alloc>::FlatHashMap() :
+		table{}
+	{
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> FlatHashMap<K, V, Hash, Alloc>::FlatHashMap(Alloc a) :
+		table{a}
+	{
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> size_t FlatHashMap<K, V, Hash, Alloc>::size() const
+	{
+		return table.size();
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> size_t FlatHashMap<K, V, Hash, Alloc>::capacity() const
+	{
+		return table.capacity();
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> bool FlatHashMap<K, V, Hash, Alloc>::empty() const
+	{
+		return table.size() == 0;
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> Alloc& FlatHashMap<K, V, Hash, Alloc>::allocator()
+	{
+		return table.allocator();
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> const Alloc& FlatHashMap<K, V, Hash, Alloc>::allocator() const
+	{
+		return table.allocator();
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> V* FlatHashMap<K, V, Hash, Alloc>::find(const K& key)
+	{
+		size_t i = table.find(key);
+		return i != hidden::flat_npos ? &table.slot(i).value : nullptr;
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> const V* FlatHashMap<K, V, Hash, Alloc>::find(const K& key) const
+	{
+		size_t i = table.find(key);
+		return i != hidden::flat_npos ? &table.slot(i).value : nullptr;
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> bool FlatHashMap<K, V, Hash, Alloc>::contains(const K& key) const
+	{
+		return table.find(key) != hidden::flat_npos;
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc>
+	template<typename... Args> V* FlatHashMap<K, V, Hash, Alloc>::emplace(const K& key, Args&&... args)
+	{
+		bool   found = false;
+		size_t i     = table.claim(key, found);
+
+		if(i == hidden::flat_npos)
+		{
+			return nullptr;
+		}
+
+		if(!found)
+		{
+			Slot* s = &table.slot(i);
+			new(&s->key) K(key);
+			new(&s->value) V(std::forward<Args>(args)...);
+		}
+		return &table.slot(i).value;
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> V* FlatHashMap<K, V, Hash, Alloc>::insert(const K& key, const V& value)
+	{
+		return emplace(key, value);
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> V* FlatHashMap<K, V, Hash, Alloc>::insert(const K& key, V&& value)
+	{
+		return emplace(key, std::move(value));
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> bool FlatHashMap<K, V, Hash, Alloc>::erase(const K& key)
+	{
+		return table.erase(key);
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> bool FlatHashMap<K, V, Hash, Alloc>::reserve(size_t n)
+	{
+		return table.reserve(n);
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc> void FlatHashMap<K, V, Hash, Alloc>::clear()
+	{
+		table.clear();
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc>
+	auto FlatHashMap<K, V, Hash, Alloc>::begin() -> hidden::FlatIterator<hidden::FlatTable<Slot, Hash, Alloc>, Slot&>
+	{
+		return {&table, 0};
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc>
+	auto FlatHashMap<K, V, Hash, Alloc>::end() -> hidden::FlatIterator<hidden::FlatTable<Slot, Hash, Alloc>, Slot&>
+	{
+		return {&table, table.capacity()};
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc>
+	auto FlatHashMap<K, V, Hash, Alloc>::begin() const -> hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const Slot&>
+	{
+		return {&table, 0};
+	}
+
+	template<typename K, typename V, typename Hash, typename Alloc>
+	auto FlatHashMap<K, V, Hash, Alloc>::end() const -> hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const Slot&>
+	{
+		return {&table, table.capacity()};
+	}
+
+	template<typename K, typename Hash, typename Alloc> FlatHashSet<K, Hash, Alloc>::FlatHashSet() :
+		table{}
+	{
+	}
+
+	template<typename K, typename Hash, typename Alloc> FlatHashSet<K, Hash, Alloc>::FlatHashSet(Alloc a) :
+		table{a}
+	{
+	}
+
+	template<typename K, typename Hash, typename Alloc> size_t FlatHashSet<K, Hash, Alloc>::size() const
+	{
+		return table.size();
+	}
+
+	template<typename K, typename Hash, typename Alloc> size_t FlatHashSet<K, Hash, Alloc>::capacity() const
+	{
+		return table.capacity();
+	}
+
+	template<typename K, typename Hash, typename Alloc> bool FlatHashSet<K, Hash, Alloc>::empty() const
+	{
+		return table.size() == 0;
+	}
+
+	template<typename K, typename Hash, typename Alloc> Alloc& FlatHashSet<K, Hash, Alloc>::allocator()
+	{
+		return table.allocator();
+	}
+
+	template<typename K, typename Hash, typename Alloc> const Alloc& FlatHashSet<K, Hash, Alloc>::allocator() const
+	{
+		return table.allocator();
+	}
+
+	template<typename K, typename Hash, typename Alloc> bool FlatHashSet<K, Hash, Alloc>::contains(const K& key) const
+	{
+		return table.find(key) != hidden::flat_npos;
+	}
+
+	template<typename K, typename Hash, typename Alloc> const K* FlatHashSet<K, Hash, Alloc>::insert(const K& key)
+	{
+		bool   found = false;
+		size_t i     = table.claim(key, found);
+
+		if(i == hidden::flat_npos)
+		{
+			return nullptr;
+		}
+
+		if(!found)
+		{
+			new(&table.slot(i).key) K(key);
+		}
+		return &table.slot(i).key;
+	}
+
+	template<typename K, typename Hash, typename Alloc> bool FlatHashSet<K, Hash, Alloc>::erase(const K& key)
+	{
+		return table.erase(key);
+	}
+
+	template<typename K, typename Hash, typename Alloc> bool FlatHashSet<K, Hash, Alloc>::reserve(size_t n)
+	{
+		return table.reserve(n);
+	}
+
+	template<typename K, typename Hash, typename Alloc> void FlatHashSet<K, Hash, Alloc>::clear()
+	{
+		table.clear();
+	}
+
+	template<typename K, typename Hash, typename Alloc>
+	auto FlatHashSet<K, Hash, Alloc>::begin() const -> hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const K&>
+	{
+		return {&table, 0};
+	}
+
+	template<typename K, typename Hash, typename Alloc>
+	auto FlatHashSet<K, Hash, Alloc>::end() const -> hidden::FlatIterator<const hidden::FlatTable<Slot, Hash, Alloc>, const K&>
+	{
+		return {&table, table.capacity()};
+	}
+}
+// namespace::rcom
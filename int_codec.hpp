@@ -0,0 +1,711 @@
+#pragma once
+
+// Integer compression for ArrayPtr<uint32_t>
+//
+// Delta and zigzag transforms turn sorted or slowly changing values into small ones, which the codecs then store in fewer bytes:
+// Stream VByte keeps one to four bytes per value with the lengths in separate control bytes, so decoding is a table driven shuffle.
+// Frame of reference bit-packing stores each value as a fixed number of bits above the block minimum, so any one value can be read directly.
+// CompressedIntArray splits values into independently decodable blocks for random access.
+
+#include "array.hpp"
+#include "cpu.hpp"
+#include "dynamic_array.hpp"
+#include <cstring>
+#include <utility>
+
+// Values per block of a CompressedIntArray
+#ifndef RCOM_INT_BLOCK
+	#define RCOM_INT_BLOCK 128
+#endif
+
+namespace rcom
+{
+	enum class IntCodec
+	{
+		stream_vbyte,
+		frame_of_reference
+	};
+
+	enum class IntTransform
+	{
+		none,
+		// Store differences from the previous value. For sorted values
+		delta,
+		// Store zigzag encoded differences. For values which go up and down
+		zigzag_delta
+	};
+
+	// Map signed values to unsigned so small magnitudes stay small
+	inline constexpr uint32_t zigzag_encode(int32_t v);
+	inline constexpr uint64_t zigzag_encode(int64_t v);
+	inline constexpr int32_t  zigzag_decode(uint32_t v);
+	inline constexpr int64_t  zigzag_decode(uint64_t v);
+
+	// In place transforms. prev is the value before the first element
+	template<typename T> inline void delta_encode(ArrayPtr<T> values, T prev = 0);
+	template<typename T> inline void delta_decode(ArrayPtr<T> values, T prev = 0);
+	template<typename T> inline void zigzag_delta_encode(ArrayPtr<T> values, T prev = 0);
+	template<typename T> inline void zigzag_delta_decode(ArrayPtr<T> values, T prev = 0);
+
+	// Stream VByte
+	// Encoders return the bytes written, or 0 if out is smaller than the max size
+	// Decoders fill every element of out and return the bytes read, or 0 if in is too short
+	inline constexpr size_t streamvbyte_max_size(size_t count);
+	inline size_t streamvbyte_encode(ArrayPtr<const uint32_t> in, BytePtr out);
+	inline size_t streamvbyte_decode(ArrayPtr<const uint8_t> in, ArrayPtr<uint32_t> out);
+	// Delta transform fused into the codec, saving a pass over the values
+	inline size_t streamvbyte_encode_delta(ArrayPtr<const uint32_t> in, BytePtr out, uint32_t prev = 0);
+	inline size_t streamvbyte_decode_delta(ArrayPtr<const uint8_t> in, ArrayPtr<uint32_t> out, uint32_t prev = 0);
+
+	// Frame of reference bit-packing, same return values as Stream VByte
+	inline constexpr size_t for_max_size(size_t count);
+	inline size_t   for_encode(ArrayPtr<const uint32_t> in, BytePtr out);
+	inline size_t   for_decode(ArrayPtr<const uint8_t> in, ArrayPtr<uint32_t> out);
+	// Element i of an encoded block without decoding the rest
+	inline uint32_t for_get(ArrayPtr<const uint8_t> in, size_t i);
+
+	// Compressed copy of a uint32_t array, split into blocks of RCOM_INT_BLOCK values that decode on their own
+	template<typename Alloc = MallocAllocator> class CompressedIntArray
+	{
+	public:
+		constexpr static const size_t block_size = RCOM_INT_BLOCK;
+
+		inline CompressedIntArray();
+		inline explicit CompressedIntArray(Alloc a);
+
+		// Replace the contents. Return false if memory could not be allocated
+		inline bool encode(ArrayPtr<const uint32_t> values, IntCodec codec = IntCodec::stream_vbyte, IntTransform transform = IntTransform::delta);
+		inline void clear();
+
+		inline size_t       size()        const;
+		inline size_t       block_count() const;
+		// Compressed bytes, excluding the block index
+		inline size_t       byte_size()   const;
+		inline IntCodec     codec()       const;
+		inline IntTransform transform()   const;
+
+		// Decode block b into out, which must hold block_size values. Return the number decoded
+		inline size_t decode_block(size_t b, ArrayPtr<uint32_t> out) const;
+		// Decode everything into out, which must hold size() values
+		inline void   decode(ArrayPtr<uint32_t> out) const;
+		// Single value. Reads one packed value for untransformed frame of reference, otherwise decodes its block
+		inline uint32_t get(size_t i) const;
+	private:
+		DynamicArray<uint8_t,  GrowDouble, Alloc> bytes;
+		// Start of each block in bytes, plus the end
+		DynamicArray<uint64_t, GrowDouble, Alloc> offsets;
+		// Value before each block, so delta blocks decode on their own
+		DynamicArray<uint32_t, GrowDouble, Alloc> bases;
+		size_t                                    count;
+		IntCodec                                  method;
+		IntTransform                              mode;
+	};
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	// Bytes needed for v, minus one
+	inline uint32_t vbyte_code(uint32_t v)
+	{
+		return v < (1u << 8) ? 0 : v < (1u << 16) ? 1 : v < (1u << 24) ? 2 : 3;
+	}
+
+	// Data bytes used by the four values of a control byte
+	struct VbyteLength
+	{
+		inline constexpr uint8_t operator()(size_t c) const
+		{
+			return static_cast<uint8_t>(4 + (c & 3) + ((c >> 2) & 3) + ((c >> 4) & 3) + ((c >> 6) & 3));
+		}
+	};
+
+	// Shuffle moving the packed bytes of a control byte into four 32 bit lanes. 0x80 zeroes a byte
+	struct VbyteShuffle
+	{
+		inline constexpr Array<uint8_t, 16> operator()(size_t c) const
+		{
+			Array<uint8_t, 16> s{};
+			uint8_t            from = 0;
+
+			for(size_t lane = 0; lane < 4; ++lane)
+			{
+				size_t len = ((c >> (2 * lane)) & 3) + 1;
+
+				for(size_t k = 0; k < 4; ++k)
+				{
+					s[lane * 4 + k] = k < len ? from++ : 0x80;
+				}
+			}
+			return s;
+		}
+	};
+
+	inline const Array<uint8_t, 256>& vbyte_lengths()
+	{
+		static constexpr const Array<uint8_t, 256> table = generate_array<uint8_t, 256>(VbyteLength{});
+		return table;
+	}
+
+	inline const Array<Array<uint8_t, 16>, 256>& vbyte_shuffles()
+	{
+		static constexpr const Array<Array<uint8_t, 16>, 256> table = generate_array<Array<uint8_t, 16>, 256>(VbyteShuffle{});
+		return table;
+	}
+
+	// Sum of the data lengths of n values
+	inline size_t vbyte_data_size(const uint8_t* ctrl, size_t n)
+	{
+		const Array<uint8_t, 256>& lengths = vbyte_lengths();
+		size_t                     size    = 0;
+
+		for(size_t i = 0; i < n / 4; ++i)
+		{
+			size += lengths[ctrl[i]];
+		}
+
+		for(size_t j = 0; j < n % 4; ++j)
+		{
+			size += ((ctrl[n / 4] >> (2 * j)) & 3) + 1;
+		}
+		return size;
+	}
+
+	template<bool Delta> inline size_t vbyte_encode(ArrayPtr<const uint32_t> in, BytePtr out, uint32_t prev)
+	{
+		size_t n = in.size();
+
+		RCOM_ASSERT(out.size() >= streamvbyte_max_size(n), "Output too small");
+
+		if(out.size() < streamvbyte_max_size(n))
+		{
+			return 0;
+		}
+
+		uint8_t* ctrl = out.data();
+		uint8_t* data = ctrl + (n + 3) / 4;
+
+		std::memset(ctrl, 0, (n + 3) / 4);
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			uint32_t v    = Delta ? in[i] - prev : in[i];
+			uint32_t code = vbyte_code(v);
+			prev          = in[i];
+
+			ctrl[i / 4] |= static_cast<uint8_t>(code << (2 * (i % 4)));
+
+			for(uint32_t k = 0; k <= code; ++k)
+			{
+				*data++ = static_cast<uint8_t>(v >> (8 * k));
+			}
+		}
+		return static_cast<size_t>(data - out.data());
+	}
+
+	template<bool Delta> inline const uint8_t* vbyte_decode_scalar(const uint8_t* ctrl, const uint8_t* data, uint32_t* out, size_t begin, size_t end, uint32_t& prev)
+	{
+		for(size_t i = begin; i < end; ++i)
+		{
+			uint32_t code = (ctrl[i / 4] >> (2 * (i % 4))) & 3;
+			uint32_t v    = 0;
+
+			for(uint32_t k = 0; k <= code; ++k)
+			{
+				v |= static_cast<uint32_t>(*data++) << (8 * k);
+			}
+
+			prev   = Delta ? prev + v : v;
+			out[i] = prev;
+		}
+		return data;
+	}
+
+#if defined(RCOM_X86)
+	// Prefix sum of four lanes, added to the last value of the previous group
+	RCOM_TARGET("sse2") inline __m128i prefix_sum_sse2(__m128i v, __m128i prev)
+	{
+		v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+		v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+		return _mm_add_epi32(v, _mm_shuffle_epi32(prev, _MM_SHUFFLE(3, 3, 3, 3)));
+	}
+
+	// Decodes whole control bytes while a 16 byte load stays inside the input. Return the number of values decoded
+	template<bool Delta> RCOM_TARGET("ssse3") inline size_t vbyte_decode_ssse3(const uint8_t* ctrl, const uint8_t*& data, const uint8_t* end, uint32_t* out, size_t n, uint32_t& prev)
+	{
+		const Array<uint8_t, 256>&            lengths  = vbyte_lengths();
+		const Array<Array<uint8_t, 16>, 256>& shuffles = vbyte_shuffles();
+
+		__m128i last = _mm_set1_epi32(static_cast<int>(prev));
+		size_t  i    = 0;
+
+		for(; i + 4 <= n && end - data >= 16; i += 4)
+		{
+			uint8_t c = ctrl[i / 4];
+			__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(shuffles[c].data()));
+			__m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), s);
+
+			if(Delta)
+			{
+				v    = prefix_sum_sse2(v, last);
+				last = v;
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), v);
+			data += lengths[c];
+		}
+
+		if(i)
+		{
+			prev = out[i - 1];
+		}
+		return i;
+	}
+#endif
+
+	template<bool Delta> inline size_t vbyte_decode(ArrayPtr<const uint8_t> in, ArrayPtr<uint32_t> out, uint32_t prev)
+	{
+		size_t n         = out.size();
+		size_t ctrl_size = (n + 3) / 4;
+
+		if(in.size() < ctrl_size || in.size() - ctrl_size < vbyte_data_size(in.data(), n))
+		{
+			return 0;
+		}
+
+		const uint8_t* ctrl = in.data();
+		const uint8_t* data = ctrl + ctrl_size;
+		size_t         i    = 0;
+
+#if defined(RCOM_X86)
+		if(cpu_supports(cpu_ssse3))
+		{
+			i = vbyte_decode_ssse3<Delta>(ctrl, data, in.data() + in.size(), out.data(), n, prev);
+		}
+#endif
+		data = vbyte_decode_scalar<Delta>(ctrl, data, out.data(), i, n, prev);
+		return static_cast<size_t>(data - in.data());
+	}
+
+	// Frame of reference block: uint32_t minimum, uint8_t bit width, then the packed offsets from the minimum
+	constexpr const size_t for_header = 5;
+
+	inline uint32_t for_width(uint32_t range)
+	{
+		uint32_t w = 0;
+
+		while(w < 32 && (range >> w) != 0)
+		{
+			++w;
+		}
+		return w;
+	}
+
+	// A constant width lets the compiler turn the shifts and masks into immediates
+	template<uint32_t W> inline void for_unpack(const uint8_t* p, size_t n, uint32_t base, uint32_t* out)
+	{
+		const uint64_t mask = (uint64_t(1) << W) - 1;
+
+		uint64_t acc  = 0;
+		uint32_t bits = 0;
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			while(bits < W)
+			{
+				acc  |= static_cast<uint64_t>(*p++) << bits;
+				bits += 8;
+			}
+
+			out[i] = base + static_cast<uint32_t>(acc & mask);
+			acc  >>= W;
+			bits  -= W;
+		}
+	}
+
+	template<> inline void for_unpack<0>(const uint8_t*, size_t n, uint32_t base, uint32_t* out)
+	{
+		for(size_t i = 0; i < n; ++i)
+		{
+			out[i] = base;
+		}
+	}
+
+	typedef void (*ForUnpack)(const uint8_t*, size_t, uint32_t, uint32_t*);
+
+	// Unpacker for each width from 0 to 32
+	template<size_t... W> inline const ForUnpack* for_unpackers(std::index_sequence<W...>)
+	{
+		static const ForUnpack table[] = {&for_unpack<static_cast<uint32_t>(W)>...};
+		return table;
+	}
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	constexpr uint32_t zigzag_encode(int32_t v)
+	{
+		return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+	}
+
+	constexpr uint64_t zigzag_encode(int64_t v)
+	{
+		return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+	}
+
+	constexpr int32_t zigzag_decode(uint32_t v)
+	{
+		return static_cast<int32_t>((v >> 1) ^ (0u - (v & 1)));
+	}
+
+	constexpr int64_t zigzag_decode(uint64_t v)
+	{
+		return static_cast<int64_t>((v >> 1) ^ (uint64_t(0) - (v & 1)));
+	}
+
+	template<typename T> void delta_encode(ArrayPtr<T> values, T prev)
+	{
+		static_assert(std::is_same<T, uint32_t>::value || std::is_same<T, uint64_t>::value, "Delta transforms take uint32_t or uint64_t");
+
+		for(T& v : values)
+		{
+			T cur = v;
+			v     = cur - prev;
+			prev  = cur;
+		}
+	}
+
+	template<typename T> void delta_decode(ArrayPtr<T> values, T prev)
+	{
+		static_assert(std::is_same<T, uint32_t>::value || std::is_same<T, uint64_t>::value, "Delta transforms take uint32_t or uint64_t");
+
+		for(T& v : values)
+		{
+			prev += v;
+			v     = prev;
+		}
+	}
+
+	template<typename T> void zigzag_delta_encode(ArrayPtr<T> values, T prev)
+	{
+		typedef typename std::make_signed<T>::type S;
+
+		delta_encode(values, prev);
+
+		for(T& v : values)
+		{
+			v = zigzag_encode(static_cast<S>(v));
+		}
+	}
+
+	template<typename T> void zigzag_delta_decode(ArrayPtr<T> values, T prev)
+	{
+		for(T& v : values)
+		{
+			v = static_cast<T>(zigzag_decode(v));
+		}
+
+		delta_decode(values, prev);
+	}
+
+	constexpr size_t streamvbyte_max_size(size_t count)
+	{
+		return (count + 3) / 4 + count * 4;
+	}
+
+	size_t streamvbyte_encode(ArrayPtr<const uint32_t> in, BytePtr out)
+	{
+		return hidden::vbyte_encode<false>(in, out, 0);
+	}
+
+	size_t streamvbyte_decode(ArrayPtr<const uint8_t> in, ArrayPtr<uint32_t> out)
+	{
+		return hidden::vbyte_decode<false>(in, out, 0);
+	}
+
+	size_t streamvbyte_encode_delta(ArrayPtr<const uint32_t> in, BytePtr out, uint32_t prev)
+	{
+		return hidden::vbyte_encode<true>(in, out, prev);
+	}
+
+	size_t streamvbyte_decode_delta(ArrayPtr<const uint8_t> in, ArrayPtr<uint32_t> out, uint32_t prev)
+	{
+		return hidden::vbyte_decode<true>(in, out, prev);
+	}
+
+	constexpr size_t for_max_size(size_t count)
+	{
+		return hidden::for_header + count * 4;
+	}
+
+	size_t for_encode(ArrayPtr<const uint32_t> in, BytePtr out)
+	{
+		RCOM_ASSERT(out.size() >= for_max_size(in.size()), "Output too small");
+
+		if(out.size() < for_max_size(in.size()))
+		{
+			return 0;
+		}
+
+		uint32_t lo = in.size() ? in[0] : 0;
+		uint32_t hi = lo;
+
+		for(uint32_t v : in)
+		{
+			lo = v < lo ? v : lo;
+			hi = v > hi ? v : hi;
+		}
+
+		uint32_t w = hidden::for_width(hi - lo);
+		uint8_t* p = out.data();
+
+		std::memcpy(p, &lo, sizeof(lo));
+		p[4] = static_cast<uint8_t>(w);
+		p   += hidden::for_header;
+
+		uint64_t acc  = 0;
+		uint32_t bits = 0;
+
+		for(uint32_t v : in)
+		{
+			acc  |= static_cast<uint64_t>(v - lo) << bits;
+			bits += w;
+
+			for(; bits >= 8; bits -= 8, acc >>= 8)
+			{
+				*p++ = static_cast<uint8_t>(acc);
+			}
+		}
+
+		if(bits)
+		{
+			*p++ = static_cast<uint8_t>(acc);
+		}
+		return static_cast<size_t>(p - out.data());
+	}
+
+	size_t for_decode(ArrayPtr<const uint8_t> in, ArrayPtr<uint32_t> out)
+	{
+		if(in.size() < hidden::for_header || in[4] > 32)
+		{
+			return 0;
+		}
+
+		uint32_t base;
+		uint32_t w    = in[4];
+		size_t   size = hidden::for_header + (out.size() * w + 7) / 8;
+
+		std::memcpy(&base, in.data(), sizeof(base));
+
+		if(in.size() < size)
+		{
+			return 0;
+		}
+
+		hidden::for_unpackers(std::make_index_sequence<33>{})[w](in.data() + hidden::for_header, out.size(), base, out.data());
+		return size;
+	}
+
+	uint32_t for_get(ArrayPtr<const uint8_t> in, size_t i)
+	{
+		RCOM_ASSERT(in.size() >= hidden::for_header && in[4] <= 32, "Not a frame of reference block");
+
+		uint32_t base;
+		uint32_t w   = in[4];
+		size_t   bit = i * w;
+
+		std::memcpy(&base, in.data(), sizeof(base));
+
+		// The value spans at most five bytes
+		const uint8_t* p     = in.data() + hidden::for_header + bit / 8;
+		size_t         shift = bit % 8;
+		size_t         n     = (shift + w + 7) / 8;
+		uint64_t       acc   = 0;
+
+		RCOM_ASSERT(hidden::for_header + bit / 8 + n <= in.size(), "Index out of range");
+
+		for(size_t k = 0; k < n; ++k)
+		{
+			acc |= static_cast<uint64_t>(p[k]) << (8 * k);
+		}
+		return base + static_cast<uint32_t>((acc >> shift) & ((uint64_t(1) << w) - 1));
+	}
+
+	template<typename Alloc> constexpr const size_t CompressedIntArray<Alloc>::block_size;
+
+	template<typename Alloc> CompressedIntArray<Alloc>::CompressedIntArray() :
+		bytes{},
+		offsets{},
+		bases{},
+		count{0},
+		method{IntCodec::stream_vbyte},
+		mode{IntTransform::none}
+	{
+	}
+
+	template<typename Alloc> CompressedIntArray<Alloc>::CompressedIntArray(Alloc a) :
+		bytes{a},
+		offsets{a},
+		bases{a},
+		count{0},
+		method{IntCodec::stream_vbyte},
+		mode{IntTransform::none}
+	{
+	}
+
+	template<typename Alloc> bool CompressedIntArray<Alloc>::encode(ArrayPtr<const uint32_t> values, IntCodec codec, IntTransform transform)
+	{
+		clear();
+
+		size_t blocks = (values.size() + block_size - 1) / block_size;
+		size_t worst  = codec == IntCodec::stream_vbyte ? streamvbyte_max_size(block_size) : for_max_size(block_size);
+
+		if(!bytes.resize(blocks * worst) || !offsets.reserve(blocks + 1) || !bases.reserve(blocks))
+		{
+			clear();
+			return false;
+		}
+
+		Array<uint32_t, block_size> buf;
+		size_t                      pos  = 0;
+		uint32_t                    prev = 0;
+
+		for(size_t b = 0; b < blocks; ++b)
+		{
+			ArrayPtr<const uint32_t> in  = values.slice(b * block_size, b * block_size + block_size < values.size() ? b * block_size + block_size : values.size());
+			BytePtr                  out = bytes.slice(pos, pos + worst);
+
+			offsets.push(pos);
+			bases.push(prev);
+
+			if(codec == IntCodec::stream_vbyte && transform == IntTransform::delta)
+			{
+				pos += streamvbyte_encode_delta(in, out, prev);
+			}
+			else
+			{
+				ArrayPtr<uint32_t> tmp = buf.slice(0, in.size());
+				std::memcpy(tmp.data(), in.data(), in.byte_size());
+
+				if(transform == IntTransform::delta)
+				{
+					delta_encode(tmp, prev);
+				}
+				else if(transform == IntTransform::zigzag_delta)
+				{
+					zigzag_delta_encode(tmp, prev);
+				}
+
+				pos += codec == IntCodec::stream_vbyte ? streamvbyte_encode(tmp, out) : for_encode(tmp, out);
+			}
+
+			prev = in.last();
+		}
+
+		offsets.push(pos);
+		bytes.resize(pos);
+
+		count  = values.size();
+		method = codec;
+		mode   = transform;
+		return true;
+	}
+
+	template<typename Alloc> void CompressedIntArray<Alloc>::clear()
+	{
+		bytes.clear();
+		offsets.clear();
+		bases.clear();
+		count = 0;
+	}
+
+	template<typename Alloc> size_t CompressedIntArray<Alloc>::size() const
+	{
+		return count;
+	}
+
+	template<typename Alloc> size_t CompressedIntArray<Alloc>::block_count() const
+	{
+		return bases.size();
+	}
+
+	template<typename Alloc> size_t CompressedIntArray<Alloc>::byte_size() const
+	{
+		return bytes.size();
+	}
+
+	template<typename Alloc> IntCodec CompressedIntArray<Alloc>::codec() const
+	{
+		return method;
+	}
+
+	template<typename Alloc> IntTransform CompressedIntArray<Alloc>::transform() const
+	{
+		return mode;
+	}
+
+	template<typename Alloc> size_t CompressedIntArray<Alloc>::decode_block(size_t b, ArrayPtr<uint32_t> out) const
+	{
+		RCOM_ASSERT(b < block_count(), "Index out of range");
+
+		size_t                  n  = b + 1 < block_count() ? block_size : count - b * block_size;
+		ArrayPtr<const uint8_t> in = {bytes.data() + offsets[b], static_cast<size_t>(offsets[b + 1] - offsets[b])};
+
+		RCOM_ASSERT(out.size() >= n, "Output too small");
+
+		out = out.slice(0, n);
+
+		if(method == IntCodec::stream_vbyte && mode == IntTransform::delta)
+		{
+			streamvbyte_decode_delta(in, out, bases[b]);
+			return n;
+		}
+
+		if(method == IntCodec::stream_vbyte)
+		{
+			streamvbyte_decode(in, out);
+		}
+		else
+		{
+			for_decode(in, out);
+		}
+
+		if(mode == IntTransform::delta)
+		{
+			delta_decode(out, bases[b]);
+		}
+		else if(mode == IntTransform::zigzag_delta)
+		{
+			zigzag_delta_decode(out, bases[b]);
+		}
+		return n;
+	}
+
+	template<typename Alloc> void CompressedIntArray<Alloc>::decode(ArrayPtr<uint32_t> out) const
+	{
+		RCOM_ASSERT(out.size() >= count, "Output too small");
+
+		for(size_t b = 0; b < block_count(); ++b)
+		{
+			decode_block(b, out.slice(b * block_size));
+		}
+	}
+
+	template<typename Alloc> uint32_t CompressedIntArray<Alloc>::get(size_t i) const
+	{
+		RCOM_ASSERT(i < count, "Index out of range");
+
+		size_t b = i / block_size;
+
+		if(method == IntCodec::frame_of_reference && mode == IntTransform::none)
+		{
+			return for_get({bytes.data() + offsets[b], static_cast<size_t>(offsets[b + 1] - offsets[b])}, i % block_size);
+		}
+
+		Array<uint32_t, block_size> buf;
+		decode_block(b, buf.to_ptr());
+		return buf[i % block_size];
+	}
+}
+// namespace::rcom
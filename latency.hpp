@@ -0,0 +1,540 @@
+#pragma once
+
+// Scoped timers recording into per thread latency histograms
+//
+// RCOM_TIME_SCOPE("name") times the rest of the enclosing scope in cycles.
+// Every thread records into its own histogram per site, so recording is a few plain stores with no locking or shared cache lines.
+// dump_latency merges the histograms of all threads, including ones that have exited, and prints the distribution.
+// Define RCOM_PROFILING_ENABLED to turn the timers on, otherwise RCOM_TIME_SCOPE compiles to nothing.
+
+#include "clock.hpp"
+#include "allocator.hpp"
+#include <atomic>
+#include <mutex>
+#include <new>
+
+// Most timed sites a program can have
+#if !defined(RCOM_LATENCY_MAX_SITES)
+	#define RCOM_LATENCY_MAX_SITES 256
+#endif
+
+namespace rcom
+{
+	// Log linear histogram of cycle counts
+	// Each power of two is split into 16 linear buckets, so a value is known to within about 6%
+	// Written by one thread and read by any. Counters are atomic so readers never see torn values
+	class LatencyHistogram
+	{
+	public:
+		static constexpr uint32_t sub_bits     = 4;
+		static constexpr uint32_t sub_count    = 1 << sub_bits;
+		static constexpr size_t   bucket_count = (64 - sub_bits + 1) * sub_count;
+
+		inline LatencyHistogram();
+		LatencyHistogram(const LatencyHistogram&)            = delete;
+		LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+		// Only the owning thread may record
+		inline void record(uint64_t value);
+
+		// Add other into this. This must not be recorded into concurrently
+		inline void merge(const LatencyHistogram& other);
+		inline void reset();
+
+		inline uint64_t count() const;
+		inline uint64_t sum()   const;
+		inline uint64_t min()   const;
+		inline uint64_t max()   const;
+		inline double   mean()  const;
+
+		// Value below which a fraction p of the recorded values fall, p in [0, 1]
+		inline uint64_t percentile(double p) const;
+
+		inline static size_t   bucket_index(uint64_t value);
+		// Smallest value that lands in bucket i
+		inline static uint64_t bucket_lower(size_t i);
+
+	private:
+		std::atomic<uint64_t> total;
+		std::atomic<uint64_t> total_sum;
+		std::atomic<uint64_t> lowest;
+		std::atomic<uint64_t> highest;
+		std::atomic<uint64_t> buckets[bucket_count];
+	};
+
+	// A named place in the code being timed. Declared static by RCOM_TIME_SCOPE
+	class LatencySite
+	{
+	public:
+		inline explicit LatencySite(const char* name);
+
+		inline const char* name() const;
+		inline size_t      id()   const;
+
+	private:
+		const char* site_name;
+		size_t      site_id;
+	};
+
+	// Record a value for a site into the calling thread's histogram
+	inline void record_latency(const LatencySite& site, uint64_t cycles);
+
+	// Merge every thread's histogram for a site into out
+	inline void merge_latency(const LatencySite& site, LatencyHistogram& out);
+
+	// Print count, mean and percentiles in nanoseconds for every site with samples
+	inline void dump_latency(FILE* out = stdout);
+	inline void dump_latency_csv(FILE* out = stdout);
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	inline uint32_t highest_bit(uint64_t value)
+	{
+#if defined(__GNUC__)
+		return 63 - static_cast<uint32_t>(__builtin_clzll(value));
+#else
+		uint32_t bit = 0;
+
+		while(value >>= 1)
+		{
+			++bit;
+		}
+		return bit;
+#endif
+	}
+
+	// Store without a read-modify-write. Safe because each histogram has one writer
+	inline void add_relaxed(std::atomic<uint64_t>& a, uint64_t value)
+	{
+		a.store(a.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	// One thread's histograms, indexed by site id and created on first use
+	struct ThreadLatency
+	{
+		std::atomic<LatencyHistogram*> sites[RCOM_LATENCY_MAX_SITES];
+		ThreadLatency*                 next;
+		ThreadLatency*                 prev;
+
+		inline ThreadLatency();
+		inline ~ThreadLatency();
+
+		inline LatencyHistogram* get(size_t id);
+	};
+
+	struct LatencyRegistry
+	{
+		std::mutex        mutex;
+		const char*       names[RCOM_LATENCY_MAX_SITES];
+		size_t            site_count = 0;
+		// Live threads
+		ThreadLatency*    threads    = nullptr;
+		// Samples of threads which have exited
+		LatencyHistogram* retired[RCOM_LATENCY_MAX_SITES] = {};
+		MallocAllocator   alloc;
+
+		inline LatencyHistogram* create();
+		inline void              destroy(LatencyHistogram* h);
+	};
+
+	inline LatencyRegistry& latency_registry()
+	{
+		static LatencyRegistry registry;
+		return registry;
+	}
+
+	inline ThreadLatency& thread_latency()
+	{
+		thread_local ThreadLatency data;
+		return data;
+	}
+
+	LatencyHistogram* LatencyRegistry::create()
+	{
+		ArrayPtr<LatencyHistogram> mem = allocate_array<LatencyHistogram>(alloc, 1);
+		return mem ? new(mem.data()) LatencyHistogram() : nullptr;
+	}
+
+	void LatencyRegistry::destroy(LatencyHistogram* h)
+	{
+		h->~LatencyHistogram();
+		deallocate_array(alloc, ArrayPtr<LatencyHistogram>{h, 1});
+	}
+
+	ThreadLatency::ThreadLatency()
+	{
+		for(std::atomic<LatencyHistogram*>& s : sites)
+		{
+			s.store(nullptr, std::memory_order_relaxed);
+		}
+
+		LatencyRegistry& r = latency_registry();
+		std::lock_guard<std::mutex> lock{r.mutex};
+
+		prev = nullptr;
+		next = r.threads;
+
+		if(next)
+		{
+			next->prev = this;
+		}
+		r.threads = this;
+	}
+
+	// Move the samples into the retired histograms so they outlive the thread
+	ThreadLatency::~ThreadLatency()
+	{
+		LatencyRegistry& r = latency_registry();
+		std::lock_guard<std::mutex> lock{r.mutex};
+
+		for(size_t i = 0; i < RCOM_LATENCY_MAX_SITES; ++i)
+		{
+			LatencyHistogram* h = sites[i].load(std::memory_order_relaxed);
+
+			if(!h)
+			{
+				continue;
+			}
+
+			if(!r.retired[i])
+			{
+				r.retired[i] = r.create();
+			}
+
+			if(r.retired[i])
+			{
+				r.retired[i]->merge(*h);
+			}
+			r.destroy(h);
+		}
+
+		if(prev)
+		{
+			prev->next = next;
+		}
+		else
+		{
+			r.threads = next;
+		}
+
+		if(next)
+		{
+			next->prev = prev;
+		}
+	}
+
+	LatencyHistogram* ThreadLatency::get(size_t id)
+	{
+		LatencyHistogram* h = sites[id].load(std::memory_order_relaxed);
+
+		if(!h)
+		{
+			// First sample from this thread, publish the new histogram to readers
+			h = latency_registry().create();
+			sites[id].store(h, std::memory_order_release);
+		}
+		return h;
+	}
+
+	struct LatencySummary
+	{
+		const char* name;
+		uint64_t    count;
+		double      mean;
+		double      p50;
+		double      p90;
+		double      p99;
+		double      p999;
+		double      max;
+	};
+
+	inline LatencySummary summarise(const char* name, const LatencyHistogram& h)
+	{
+		LatencySummary s;
+		s.name  = name;
+		s.count = h.count();
+		s.mean  = h.mean() / cycles_per_nanosecond();
+		s.p50   = cycles_to_nanoseconds(h.percentile(0.5));
+		s.p90   = cycles_to_nanoseconds(h.percentile(0.9));
+		s.p99   = cycles_to_nanoseconds(h.percentile(0.99));
+		s.p999  = cycles_to_nanoseconds(h.percentile(0.999));
+		s.max   = cycles_to_nanoseconds(h.max());
+		return s;
+	}
+
+	// Merge retired and live histograms for a site. Caller holds the registry lock
+	inline void merge_site(LatencyRegistry& r, size_t id, LatencyHistogram& out)
+	{
+		if(r.retired[id])
+		{
+			out.merge(*r.retired[id]);
+		}
+
+		for(ThreadLatency* t = r.threads; t; t = t->next)
+		{
+			LatencyHistogram* h = t->sites[id].load(std::memory_order_acquire);
+
+			if(h)
+			{
+				out.merge(*h);
+			}
+		}
+	}
+
+	// Call func(summary) for every site with samples
+	template<typename Func> inline void for_each_latency(Func func)
+	{
+		LatencyRegistry&  r = latency_registry();
+		LatencyHistogram* h = r.create();
+
+		if(!h)
+		{
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock{r.mutex};
+
+			for(size_t i = 0; i < r.site_count; ++i)
+			{
+				h->reset();
+				merge_site(r, i, *h);
+
+				if(h->count())
+				{
+					func(summarise(r.names[i], *h));
+				}
+			}
+		}
+
+		r.destroy(h);
+	}
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	LatencyHistogram::LatencyHistogram()
+	{
+		reset();
+	}
+
+	void LatencyHistogram::record(uint64_t value)
+	{
+		hidden::add_relaxed(buckets[bucket_index(value)], 1);
+		hidden::add_relaxed(total, 1);
+		hidden::add_relaxed(total_sum, value);
+
+		if(value < lowest.load(std::memory_order_relaxed))
+		{
+			lowest.store(value, std::memory_order_relaxed);
+		}
+
+		if(value > highest.load(std::memory_order_relaxed))
+		{
+			highest.store(value, std::memory_order_relaxed);
+		}
+	}
+
+	void LatencyHistogram::merge(const LatencyHistogram& other)
+	{
+		for(size_t i = 0; i < bucket_count; ++i)
+		{
+			hidden::add_relaxed(buckets[i], other.buckets[i].load(std::memory_order_relaxed));
+		}
+
+		if(other.count())
+		{
+			if(other.min() < lowest.load(std::memory_order_relaxed))
+			{
+				lowest.store(other.min(), std::memory_order_relaxed);
+			}
+
+			if(other.max() > highest.load(std::memory_order_relaxed))
+			{
+				highest.store(other.max(), std::memory_order_relaxed);
+			}
+		}
+
+		hidden::add_relaxed(total,     other.count());
+		hidden::add_relaxed(total_sum, other.sum());
+	}
+
+	void LatencyHistogram::reset()
+	{
+		for(std::atomic<uint64_t>& b : buckets)
+		{
+			b.store(0, std::memory_order_relaxed);
+		}
+
+		total.store(0, std::memory_order_relaxed);
+		total_sum.store(0, std::memory_order_relaxed);
+		lowest.store(UINT64_MAX, std::memory_order_relaxed);
+		highest.store(0, std::memory_order_relaxed);
+	}
+
+	uint64_t LatencyHistogram::count() const
+	{
+		return total.load(std::memory_order_relaxed);
+	}
+
+	uint64_t LatencyHistogram::sum() const
+	{
+		return total_sum.load(std::memory_order_relaxed);
+	}
+
+	uint64_t LatencyHistogram::min() const
+	{
+		return count() ? lowest.load(std::memory_order_relaxed) : 0;
+	}
+
+	uint64_t LatencyHistogram::max() const
+	{
+		return highest.load(std::memory_order_relaxed);
+	}
+
+	double LatencyHistogram::mean() const
+	{
+		uint64_t n = count();
+		return n ? static_cast<double>(sum()) / static_cast<double>(n) : 0.0;
+	}
+
+	uint64_t LatencyHistogram::percentile(double p) const
+	{
+		uint64_t n = count();
+
+		if(n == 0)
+		{
+			return 0;
+		}
+
+		// Rank of the wanted sample, 1 based
+		uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(n) + 0.5);
+		rank          = rank < 1 ? 1 : rank > n ? n : rank;
+
+		uint64_t seen = 0;
+
+		for(size_t i = 0; i < bucket_count; ++i)
+		{
+			seen += buckets[i].load(std::memory_order_relaxed);
+
+			if(seen >= rank)
+			{
+				// Report the middle of the bucket, clamped to what was actually seen
+				uint64_t lo  = bucket_lower(i);
+				uint64_t hi  = i + 1 < bucket_count ? bucket_lower(i + 1) - 1 : UINT64_MAX;
+				uint64_t mid = lo + (hi - lo) / 2;
+				return mid < min() ? min() : mid > max() ? max() : mid;
+			}
+		}
+		return max();
+	}
+
+	size_t LatencyHistogram::bucket_index(uint64_t value)
+	{
+		if(value < sub_count)
+		{
+			return static_cast<size_t>(value);
+		}
+
+		uint32_t shift = hidden::highest_bit(value) - sub_bits;
+		uint64_t sub   = (value >> shift) & (sub_count - 1);
+		return (shift + 1) * sub_count + static_cast<size_t>(sub);
+	}
+
+	uint64_t LatencyHistogram::bucket_lower(size_t i)
+	{
+		if(i < sub_count)
+		{
+			return i;
+		}
+
+		size_t shift = i / sub_count - 1;
+		size_t sub   = i % sub_count;
+		return static_cast<uint64_t>(sub_count + sub) << shift;
+	}
+
+	LatencySite::LatencySite(const char* name) : site_name{name}, site_id{RCOM_LATENCY_MAX_SITES}
+	{
+		hidden::LatencyRegistry& r = hidden::latency_registry();
+		std::lock_guard<std::mutex> lock{r.mutex};
+
+		RCOM_ASSERT(r.site_count < RCOM_LATENCY_MAX_SITES, "Too many latency sites, raise RCOM_LATENCY_MAX_SITES");
+
+		if(r.site_count < RCOM_LATENCY_MAX_SITES)
+		{
+			site_id           = r.site_count++;
+			r.names[site_id]  = name;
+		}
+	}
+
+	const char* LatencySite::name() const
+	{
+		return site_name;
+	}
+
+	size_t LatencySite::id() const
+	{
+		return site_id;
+	}
+
+	void record_latency(const LatencySite& site, uint64_t cycles)
+	{
+		if(site.id() >= RCOM_LATENCY_MAX_SITES)
+		{
+			return;
+		}
+
+		LatencyHistogram* h = hidden::thread_latency().get(site.id());
+
+		if(h)
+		{
+			h->record(cycles);
+		}
+	}
+
+	void merge_latency(const LatencySite& site, LatencyHistogram& out)
+	{
+		if(site.id() >= RCOM_LATENCY_MAX_SITES)
+		{
+			return;
+		}
+
+		hidden::LatencyRegistry& r = hidden::latency_registry();
+		std::lock_guard<std::mutex> lock{r.mutex};
+		hidden::merge_site(r, site.id(), out);
+	}
+
+	void dump_latency(FILE* out)
+	{
+		fprintf(out, "%-40s %12s %12s %12s %12s %12s %12s %12s\n", "name", "count", "mean ns", "p50 ns", "p90 ns", "p99 ns", "p99.9 ns", "max ns");
+
+		hidden::for_each_latency([&](const hidden::LatencySummary& s)
+		{
+			fprintf(out, "%-40s %12llu %12.1f %12.1f %12.1f %12.1f %12.1f %12.1f\n", s.name, static_cast<unsigned long long>(s.count), s.mean, s.p50, s.p90, s.p99, s.p999, s.max);
+		});
+	}
+
+	void dump_latency_csv(FILE* out)
+	{
+		fprintf(out, "name,count,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n");
+
+		hidden::for_each_latency([&](const hidden::LatencySummary& s)
+		{
+			fprintf(out, "%s,%llu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f\n", s.name, static_cast<unsigned long long>(s.count), s.mean, s.p50, s.p90, s.p99, s.p999, s.max);
+		});
+	}
+}
+// namespace::rcom
+
+#if defined(RCOM_PROFILING_ENABLED)
+	// Time the rest of the enclosing scope and record it under NAME, a string literal
+	#define RCOM_TIME_SCOPE(NAME) \
+		static rcom::LatencySite RCOM_CONCAT(zz_latency_site, __LINE__){NAME}; \
+		const uint64_t RCOM_CONCAT(zz_latency_start, __LINE__) = rcom::read_cycles(); \
+		RCOM_DEFER_TO_SCOPE{rcom::record_latency(RCOM_CONCAT(zz_latency_site, __LINE__), rcom::read_cycles() - RCOM_CONCAT(zz_latency_start, __LINE__));}
+#else
+	#define RCOM_TIME_SCOPE(NAME)
+#endif
@@ -0,0 +1,275 @@
+#pragma once
+
+// Memory mapped files exposed as zero copy ArrayPtr views (POSIX)
+
+#include "array_ptr.hpp"
+#include <type_traits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace rcom
+{
+	enum class MapAccess
+	{
+		read_only,
+		read_write
+	};
+
+	enum class MapAdvice
+	{
+		normal,
+		sequential,
+		random,
+		will_need,
+		dont_need
+	};
+
+	class MappedFile
+	{
+	public:
+		inline MappedFile();
+		inline MappedFile(MappedFile&& other);
+		inline MappedFile& operator=(MappedFile&& other);
+		inline ~MappedFile();
+
+		MappedFile(const MappedFile&)            = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// Return false if the file could not be mapped. Empty files map to a null region
+		inline bool open(const char* path, MapAccess access = MapAccess::read_only);
+		inline void close();
+
+		inline operator bool()      const;
+		inline size_t    size()     const;
+		inline MapAccess access()   const;
+
+		inline BytePtr                 to_bytes();
+		inline ArrayPtr<const uint8_t> to_bytes() const;
+
+		// Typed views. Return nullptr if the range is outside the file or misaligned for T
+		template<typename T>
+		inline ArrayPtr<const T> view(size_t byte_offset, size_t count) const;
+		template<typename T>
+		inline ArrayPtr<const T> view(size_t byte_offset = 0) const;
+		// Writable view, the file must be mapped read_write
+		template<typename T>
+		inline ArrayPtr<T> view_mut(size_t byte_offset, size_t count);
+
+		// Hint the expected access pattern to the kernel. Return false if the hint was rejected
+		inline bool advise(MapAdvice advice);
+		inline bool advise(MapAdvice advice, size_t byte_offset, size_t length);
+
+		// Write dirty pages back to the file
+		inline bool flush();
+	private:
+		BytePtr   region;
+		MapAccess mode;
+		bool      mapped;
+
+		inline bool in_range(size_t byte_offset, size_t length, size_t align) const;
+	};
+
+	MappedFile::MappedFile() :
+		region{},
+		mode{MapAccess::read_only},
+		mapped{false}
+	{
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) :
+		region{other.region},
+		mode{other.mode},
+		mapped{other.mapped}
+	{
+		other.region = nullptr;
+		other.mapped = false;
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other)
+	{
+		if(this != &other)
+		{
+			close();
+			region       = other.region;
+			mode         = other.mode;
+			mapped       = other.mapped;
+			other.region = nullptr;
+			other.mapped = false;
+		}
+		return *this;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	bool MappedFile::open(const char* path, MapAccess access)
+	{
+		RCOM_ASSERT(path, "Null pointer");
+
+		close();
+
+		int fd = ::open(path, access == MapAccess::read_write ? O_RDWR : O_RDONLY);
+
+		if(fd < 0)
+		{
+			return false;
+		}
+
+		// The mapping keeps the file alive once the descriptor is closed
+		RCOM_DEFER_TO_SCOPE{::close(fd);};
+
+		struct stat st;
+
+		if(fstat(fd, &st) != 0)
+		{
+			return false;
+		}
+
+		size_t len = static_cast<size_t>(st.st_size);
+		mode       = access;
+		mapped     = true;
+
+		if(len == 0)
+		{
+			return true;
+		}
+
+		int   prot  = access == MapAccess::read_write ? PROT_READ | PROT_WRITE : PROT_READ;
+		int   flags = access == MapAccess::read_write ? MAP_SHARED : MAP_PRIVATE;
+		void* mem   = mmap(nullptr, len, prot, flags, fd, 0);
+
+		if(mem == MAP_FAILED)
+		{
+			mapped = false;
+			return false;
+		}
+
+		region = {static_cast<uint8_t*>(mem), len};
+		return true;
+	}
+
+	void MappedFile::close()
+	{
+		if(region)
+		{
+			munmap(region.data(), region.size());
+		}
+
+		region = nullptr;
+		mapped = false;
+	}
+
+	MappedFile::operator bool() const
+	{
+		return mapped;
+	}
+
+	size_t MappedFile::size() const
+	{
+		return region.size();
+	}
+
+	MapAccess MappedFile::access() const
+	{
+		return mode;
+	}
+
+	BytePtr MappedFile::to_bytes()
+	{
+		return region;
+	}
+
+	ArrayPtr<const uint8_t> MappedFile::to_bytes() const
+	{
+		return region;
+	}
+
+	bool MappedFile::in_range(size_t byte_offset, size_t length, size_t align) const
+	{
+		return region &&
+		       byte_offset <= region.size() &&
+		       length      <= region.size() - byte_offset &&
+		       reinterpret_cast<uintptr_t>(region.data() + byte_offset) % align == 0;
+	}
+
+	template<typename T> ArrayPtr<const T> MappedFile::view(size_t byte_offset, size_t count) const
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Mapped types must be trivially copyable");
+
+		if(count > region.size() / sizeof(T) || !in_range(byte_offset, ::byte_size<T>(count), alignof(T)))
+		{
+			return nullptr;
+		}
+
+		return {reinterpret_cast<const T*>(region.data() + byte_offset), count};
+	}
+
+	template<typename T> ArrayPtr<const T> MappedFile::view(size_t byte_offset) const
+	{
+		if(byte_offset > region.size())
+		{
+			return nullptr;
+		}
+
+		return view<T>(byte_offset, (region.size() - byte_offset) / sizeof(T));
+	}
+
+	template<typename T> ArrayPtr<T> MappedFile::view_mut(size_t byte_offset, size_t count)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Mapped types must be trivially copyable");
+		RCOM_ASSERT(mode == MapAccess::read_write, "File is mapped read only");
+
+		if(mode != MapAccess::read_write || count > region.size() / sizeof(T) || !in_range(byte_offset, ::byte_size<T>(count), alignof(T)))
+		{
+			return nullptr;
+		}
+
+		return {reinterpret_cast<T*>(region.data() + byte_offset), count};
+	}
+
+	bool MappedFile::advise(MapAdvice advice)
+	{
+		return advise(advice, 0, region.size());
+	}
+
+	bool MappedFile::advise(MapAdvice advice, size_t byte_offset, size_t length)
+	{
+		if(!in_range(byte_offset, length, 1))
+		{
+			return false;
+		}
+
+		// madvise needs a page aligned start
+		uintptr_t page  = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+		uintptr_t start = reinterpret_cast<uintptr_t>(region.data() + byte_offset);
+		uintptr_t base  = start & ~(page - 1);
+
+		int hint = MADV_NORMAL;
+
+		switch(advice)
+		{
+			case MapAdvice::normal:     hint = MADV_NORMAL;     break;
+			case MapAdvice::sequential: hint = MADV_SEQUENTIAL; break;
+			case MapAdvice::random:     hint = MADV_RANDOM;     break;
+			case MapAdvice::will_need:  hint = MADV_WILLNEED;   break;
+			case MapAdvice::dont_need:  hint = MADV_DONTNEED;   break;
+		}
+
+		return madvise(reinterpret_cast<void*>(base), length + (start - base), hint) == 0;
+	}
+
+	bool MappedFile::flush()
+	{
+		if(!region || mode != MapAccess::read_write)
+		{
+			return true;
+		}
+
+		return msync(region.data(), region.size(), MS_SYNC) == 0;
+	}
+}
+// namespace::rcom
@@ -0,0 +1,438 @@
+#pragma once
+
+// Non owning N dimensional view with runtime extents and strides
+//
+// Strides are in elements, so any layout can be described: row major, column major, or a slice of either.
+// Slicing and swapping axes only change extents and strides, never the data.
+
+#include "array.hpp"
+
+namespace rcom
+{
+	enum class MdLayout
+	{
+		// Last axis contiguous
+		row_major,
+		// First axis contiguous
+		column_major
+	};
+
+	template<typename T, size_t Rank> class MdArrayPtr
+	{
+	public:
+		static_assert(Rank > 0, "MdArrayPtr must have at least one axis");
+
+		typedef Array<size_t, Rank> Extents;
+
+		inline MdArrayPtr();
+		inline MdArrayPtr(std::nullptr_t);
+		// Densely packed in the given layout
+		inline MdArrayPtr(T* data, const Extents& extents, MdLayout layout = MdLayout::row_major);
+		// Arbitrary strides in elements
+		inline MdArrayPtr(T* data, const Extents& extents, const Extents& strides);
+
+		inline operator MdArrayPtr<const T, Rank>() const;
+		inline operator bool()                      const;
+
+		inline static constexpr size_t rank();
+
+		inline size_t extent(size_t axis) const;
+		inline size_t stride(size_t axis) const;
+		inline const Extents& extents()   const;
+		inline const Extents& strides()   const;
+
+		// Number of elements
+		inline size_t size() const;
+		// True if the elements are densely packed in row major order
+		inline bool is_contiguous() const;
+
+		// Element at one index per axis
+		template<typename... I> inline       T& operator()(I... index);
+		template<typename... I> inline const T& operator()(I... index) const;
+
+		// Same rank view of [start, end) along axis
+		inline MdArrayPtr slice(size_t axis, size_t start, size_t end) const;
+
+		// View with axis fixed at index, one rank lower
+		inline MdArrayPtr<T, Rank - 1> subview(size_t axis, size_t index) const;
+
+		// Exchange two axes. swap_axes(0, 1) of a matrix is its transpose
+		inline MdArrayPtr swap_axes(size_t a, size_t b) const;
+
+		// Flat view, only valid when contiguous
+		inline       ArrayPtr<T> to_flat();
+		inline const ArrayPtr<T> to_flat() const;
+
+		inline       T* data();
+		inline const T* data() const;
+	private:
+		T*      ptr;
+		Extents dims;
+		Extents steps;
+	};
+
+	// View of a fixed size multidimensional Array
+	template<typename T, size_t N, size_t... NS> inline MdArrayPtr<T, 1 + sizeof...(NS)> to_md_ptr(Array<T, N, NS...>& arr);
+	template<typename T, size_t N, size_t... NS> inline MdArrayPtr<const T, 1 + sizeof...(NS)> to_md_ptr(const Array<T, N, NS...>& arr);
+
+	// Call func(tile) for each block of up to tile[axis] elements along every axis
+	// Tiles are visited with the smallest stride axis innermost, so consecutive tiles are close in memory
+	template<typename T, size_t Rank, typename Func> inline void for_each_tile(MdArrayPtr<T, Rank> view, const Array<size_t, Rank>& tile, Func func);
+
+	// Call func(element) for every element, smallest stride axis innermost
+	template<typename T, size_t Rank, typename Func> inline void for_each_element(MdArrayPtr<T, Rank> view, Func func);
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank>::MdArrayPtr() :
+		ptr{nullptr},
+		dims{},
+		steps{}
+	{
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank>::MdArrayPtr(std::nullptr_t) :
+		MdArrayPtr{}
+	{
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank>::MdArrayPtr(T* data, const Extents& extents, MdLayout layout) :
+		ptr{data},
+		dims(extents),
+		steps{}
+	{
+		size_t s = 1;
+
+		if(layout == MdLayout::row_major)
+		{
+			for(size_t i = Rank; i-- > 0;)
+			{
+				steps[i] = s;
+				s       *= dims[i];
+			}
+		}
+		else
+		{
+			for(size_t i = 0; i < Rank; ++i)
+			{
+				steps[i] = s;
+				s       *= dims[i];
+			}
+		}
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank>::MdArrayPtr(T* data, const Extents& extents, const Extents& strides) :
+		ptr{data},
+		dims(extents),
+		steps(strides)
+	{
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank>::operator MdArrayPtr<const T, Rank>() const
+	{
+		return {ptr, dims, steps};
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank>::operator bool() const
+	{
+		return ptr != nullptr;
+	}
+
+	template<typename T, size_t Rank> constexpr size_t MdArrayPtr<T, Rank>::rank()
+	{
+		return Rank;
+	}
+
+	template<typename T, size_t Rank> size_t MdArrayPtr<T, Rank>::extent(size_t axis) const
+	{
+		RCOM_ASSERT(axis < Rank, "Axis out of range");
+		return dims[axis];
+	}
+
+	template<typename T, size_t Rank> size_t MdArrayPtr<T, Rank>::stride(size_t axis) const
+	{
+		RCOM_ASSERT(axis < Rank, "Axis out of range");
+		return steps[axis];
+	}
+
+	template<typename T, size_t Rank> auto MdArrayPtr<T, Rank>::extents() const -> const Extents&
+	{
+		return dims;
+	}
+
+	template<typename T, size_t Rank> auto MdArrayPtr<T, Rank>::strides() const -> const Extents&
+	{
+		return steps;
+	}
+
+	template<typename T, size_t Rank> size_t MdArrayPtr<T, Rank>::size() const
+	{
+		size_t n = 1;
+
+		for(size_t d : dims)
+		{
+			n *= d;
+		}
+		return n;
+	}
+
+	template<typename T, size_t Rank> bool MdArrayPtr<T, Rank>::is_contiguous() const
+	{
+		size_t s = 1;
+
+		for(size_t i = Rank; i-- > 0;)
+		{
+			if(dims[i] != 1 && steps[i] != s)
+			{
+				return false;
+			}
+			s *= dims[i];
+		}
+		return true;
+	}
+
+	template<typename T, size_t Rank>
+	template<typename... I> T& MdArrayPtr<T, Rank>::operator()(I... index)
+	{
+		static_assert(sizeof...(I) == Rank, "Need one index per axis");
+
+		const size_t at[] = {static_cast<size_t>(index)...};
+		size_t       off  = 0;
+
+		for(size_t i = 0; i < Rank; ++i)
+		{
+			RCOM_ASSERT(at[i] < dims[i], "Index out of range");
+			off += at[i] * steps[i];
+		}
+		return ptr[off];
+	}
+
+	template<typename T, size_t Rank>
+	template<typename... I> const T& MdArrayPtr<T, Rank>::operator()(I... index) const
+	{
+		return const_cast<MdArrayPtr*>(this)->operator()(index...);
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank> MdArrayPtr<T, Rank>::slice(size_t axis, size_t start, size_t end) const
+	{
+		RCOM_ASSERT(axis < Rank,        "Axis out of range");
+		RCOM_ASSERT(end  <= dims[axis], "Index out of range");
+		RCOM_ASSERT(start < end,        "Invaid start and end points");
+
+		MdArrayPtr view = *this;
+		view.ptr        = ptr + start * steps[axis];
+		view.dims[axis] = end - start;
+		return view;
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank - 1> MdArrayPtr<T, Rank>::subview(size_t axis, size_t index) const
+	{
+		static_assert(Rank > 1, "Cannot take a subview of a one dimensional view");
+
+		RCOM_ASSERT(axis  < Rank,       "Axis out of range");
+		RCOM_ASSERT(index < dims[axis], "Index out of range");
+
+		Array<size_t, Rank - 1> d;
+		Array<size_t, Rank - 1> s;
+
+		for(size_t i = 0, j = 0; i < Rank; ++i)
+		{
+			if(i != axis)
+			{
+				d[j] = dims[i];
+				s[j] = steps[i];
+				++j;
+			}
+		}
+
+		return {ptr + index * steps[axis], d, s};
+	}
+
+	template<typename T, size_t Rank> MdArrayPtr<T, Rank> MdArrayPtr<T, Rank>::swap_axes(size_t a, size_t b) const
+	{
+		RCOM_ASSERT(a < Rank && b < Rank, "Axis out of range");
+
+		MdArrayPtr view = *this;
+		view.dims[a]    = dims[b];
+		view.dims[b]    = dims[a];
+		view.steps[a]   = steps[b];
+		view.steps[b]   = steps[a];
+		return view;
+	}
+
+	template<typename T, size_t Rank> ArrayPtr<T> MdArrayPtr<T, Rank>::to_flat()
+	{
+		RCOM_ASSERT(is_contiguous(), "View is not contiguous");
+		return {ptr, size()};
+	}
+
+	template<typename T, size_t Rank> const ArrayPtr<T> MdArrayPtr<T, Rank>::to_flat() const
+	{
+		RCOM_ASSERT(is_contiguous(), "View is not contiguous");
+		return {ptr, size()};
+	}
+
+	template<typename T, size_t Rank> T* MdArrayPtr<T, Rank>::data()
+	{
+		return ptr;
+	}
+
+	template<typename T, size_t Rank> const T* MdArrayPtr<T, Rank>::data() const
+	{
+		return ptr;
+	}
+
+	template<typename T, size_t N, size_t... NS> MdArrayPtr<T, 1 + sizeof...(NS)> to_md_ptr(Array<T, N, NS...>& arr)
+	{
+		const size_t                     dims[] = {N, NS...};
+		Array<size_t, 1 + sizeof...(NS)> extents{};
+
+		for(size_t i = 0; i < 1 + sizeof...(NS); ++i)
+		{
+			extents[i] = dims[i];
+		}
+		return {reinterpret_cast<T*>(arr.data()), extents};
+	}
+
+	template<typename T, size_t N, size_t... NS> MdArrayPtr<const T, 1 + sizeof...(NS)> to_md_ptr(const Array<T, N, NS...>& arr)
+	{
+		const size_t                     dims[] = {N, NS...};
+		Array<size_t, 1 + sizeof...(NS)> extents{};
+
+		for(size_t i = 0; i < 1 + sizeof...(NS); ++i)
+		{
+			extents[i] = dims[i];
+		}
+		return {reinterpret_cast<const T*>(arr.data()), extents};
+	}
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	// Axes ordered from largest to smallest stride, so the last one is walked innermost
+	template<size_t Rank> inline Array<size_t, Rank> md_axis_order(const Array<size_t, Rank>& strides)
+	{
+		Array<size_t, Rank> order;
+
+		for(size_t i = 0; i < Rank; ++i)
+		{
+			order[i] = i;
+		}
+
+		// Insertion sort, rank is small
+		for(size_t i = 1; i < Rank; ++i)
+		{
+			for(size_t j = i; j > 0 && strides[order[j - 1]] < strides[order[j]]; --j)
+			{
+				size_t t     = order[j];
+				order[j]     = order[j - 1];
+				order[j - 1] = t;
+			}
+		}
+		return order;
+	}
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	template<typename T, size_t Rank, typename Func> void for_each_tile(MdArrayPtr<T, Rank> view, const Array<size_t, Rank>& tile, Func func)
+	{
+		for(size_t i = 0; i < Rank; ++i)
+		{
+			RCOM_ASSERT(tile[i] > 0, "Tile must be non empty");
+
+			if(view.extent(i) == 0)
+			{
+				return;
+			}
+		}
+
+		const Array<size_t, Rank> order = hidden::md_axis_order(view.strides());
+		Array<size_t, Rank>       start = {};
+
+		for(;;)
+		{
+			MdArrayPtr<T, Rank> t = view;
+
+			for(size_t i = 0; i < Rank; ++i)
+			{
+				size_t end = start[i] + tile[i] < view.extent(i) ? start[i] + tile[i] : view.extent(i);
+				t          = t.slice(i, start[i], end);
+			}
+
+			func(t);
+
+			// Advance the innermost axis first
+			size_t k = Rank;
+
+			while(k-- > 0)
+			{
+				size_t axis  = order[k];
+				start[axis] += tile[axis];
+
+				if(start[axis] < view.extent(axis))
+				{
+					break;
+				}
+				start[axis] = 0;
+			}
+
+			if(k == size_t(-1))
+			{
+				return;
+			}
+		}
+	}
+
+	template<typename T, size_t Rank, typename Func> void for_each_element(MdArrayPtr<T, Rank> view, Func func)
+	{
+		for(size_t i = 0; i < Rank; ++i)
+		{
+			if(view.extent(i) == 0)
+			{
+				return;
+			}
+		}
+
+		const Array<size_t, Rank> order = hidden::md_axis_order(view.strides());
+		const size_t              inner = order[Rank - 1];
+		const size_t              count = view.extent(inner);
+		const size_t              step  = view.stride(inner);
+		Array<size_t, Rank>       index = {};
+
+		for(;;)
+		{
+			T* p = view.data();
+
+			for(size_t i = 0; i < Rank; ++i)
+			{
+				p += index[i] * view.stride(i);
+			}
+
+			// Innermost run as a plain strided loop the compiler can vectorise
+			for(size_t i = 0; i < count; ++i)
+			{
+				func(p[i * step]);
+			}
+
+			size_t k = Rank - 1;
+
+			while(k-- > 0)
+			{
+				size_t axis = order[k];
+
+				if(++index[axis] < view.extent(axis))
+				{
+					break;
+				}
+				index[axis] = 0;
+			}
+
+			if(k == size_t(-1))
+			{
+				return;
+			}
+		}
+	}
+}
+// namespace::rcom
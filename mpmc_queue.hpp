@@ -0,0 +1,351 @@
+#pragma once
+
+// Bounded lock free multi producer multi consumer queue over caller provided slots
+//
+// Each slot carries a sequence number saying which lap of the ring it is ready for (Vyukov).
+// Producers and consumers claim positions with a compare and swap on their own index, then wait only on the slot they claimed,
+// so threads on different slots never touch the same cache line. Bulk operations claim a run of ready slots with one compare and swap.
+
+#include "array_ptr.hpp"
+#include "cpu.hpp"
+#include <atomic>
+#include <thread>
+
+namespace rcom
+{
+	template<typename T> class MpmcQueue
+	{
+	public:
+		struct Slot
+		{
+			std::atomic<size_t> sequence;
+			T                   value;
+		};
+
+		// Capacity is storage.size(), which must be a power of two. Values are assigned into the slots, not constructed
+		inline explicit MpmcQueue(ArrayPtr<Slot> storage);
+
+		MpmcQueue(const MpmcQueue&)            = delete;
+		MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+		inline size_t capacity() const;
+		// Approximate while other threads are active
+		inline size_t size()     const;
+		inline bool   empty()    const;
+
+		// Return false if the queue is full
+		inline bool try_push(const T& value);
+		inline bool try_push(T&& value);
+		// Spin, then yield, until there is room
+		inline void push(const T& value);
+		inline void push(T&& value);
+
+		// Return false if the queue is empty
+		inline bool try_pop(T& out);
+		// Spin, then yield, until there is a value
+		inline void pop(T& out);
+
+		// Push as many values as are free in one run, return the number pushed
+		inline size_t try_push_bulk(ArrayPtr<const T> values);
+		// Push every value, waiting for room as needed
+		inline void   push_bulk(ArrayPtr<const T> values);
+
+		// Pop up to out.size() values that are ready in one run, return the number popped
+		inline size_t try_pop_bulk(ArrayPtr<T> out);
+		// Wait for at least one value, then pop up to out.size(). Return the number popped
+		inline size_t pop_bulk(ArrayPtr<T> out);
+	private:
+		// Producer and consumer indices on their own cache lines
+		struct alignas(RCOM_CACHE_LINE_SIZE) Index
+		{
+			std::atomic<size_t> pos;
+		};
+
+		Index          enqueue;
+		Index          dequeue;
+		ArrayPtr<Slot> slots;
+		size_t         mask;
+
+		template<typename U> inline bool   try_push_imp(U&& value);
+		inline size_t                      claim_push(size_t max, size_t& start);
+		inline size_t                      claim_pop(size_t max, size_t& start);
+	};
+
+	namespace hidden
+	{
+		// Busy wait a little before giving the core away
+		inline void backoff(uint32_t& spins)
+		{
+			if(spins < 64)
+			{
+				++spins;
+				cpu_relax();
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+	// namespace hidden
+
+	template<typename T> MpmcQueue<T>::MpmcQueue(ArrayPtr<Slot> storage) :
+		slots{storage},
+		mask{storage.size() - 1}
+	{
+		RCOM_ASSERT(storage, "Null pointer");
+		RCOM_ASSERT((storage.size() & mask) == 0, "Queue capacity must be a power of two");
+
+		for(size_t i = 0; i < storage.size(); ++i)
+		{
+			slots.data()[i].sequence.store(i, std::memory_order_relaxed);
+		}
+
+		enqueue.pos.store(0, std::memory_order_relaxed);
+		dequeue.pos.store(0, std::memory_order_release);
+	}
+
+	template<typename T> size_t MpmcQueue<T>::capacity() const
+	{
+		return slots.size();
+	}
+
+	template<typename T> size_t MpmcQueue<T>::size() const
+	{
+		size_t head = dequeue.pos.load(std::memory_order_acquire);
+		size_t tail = enqueue.pos.load(std::memory_order_acquire);
+		return tail > head ? tail - head : 0;
+	}
+
+	template<typename T> bool MpmcQueue<T>::empty() const
+	{
+		return size() == 0;
+	}
+
+	template<typename T> template<typename U> bool MpmcQueue<T>::try_push_imp(U&& value)
+	{
+		size_t pos = enqueue.pos.load(std::memory_order_relaxed);
+
+		while(true)
+		{
+			Slot&    slot = slots.data()[pos & mask];
+			size_t   seq  = slot.sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq - pos);
+
+			if(diff == 0)
+			{
+				// Slot is free for this lap, claim it. On failure pos is reloaded
+				if(enqueue.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					slot.value = std::forward<U>(value);
+					slot.sequence.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if(diff < 0)
+			{
+				// Still holds the value from the previous lap
+				return false;
+			}
+			else
+			{
+				// Another producer claimed it first
+				pos = enqueue.pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	template<typename T> bool MpmcQueue<T>::try_push(const T& value)
+	{
+		return try_push_imp(value);
+	}
+
+	template<typename T> bool MpmcQueue<T>::try_push(T&& value)
+	{
+		return try_push_imp(std::move(value));
+	}
+
+	template<typename T> void MpmcQueue<T>::push(const T& value)
+	{
+		for(uint32_t spins = 0; !try_push_imp(value);)
+		{
+			hidden::backoff(spins);
+		}
+	}
+
+	template<typename T> void MpmcQueue<T>::push(T&& value)
+	{
+		// A failed try_push_imp does not move from value
+		for(uint32_t spins = 0; !try_push_imp(std::move(value));)
+		{
+			hidden::backoff(spins);
+		}
+	}
+
+	template<typename T> bool MpmcQueue<T>::try_pop(T& out)
+	{
+		size_t pos = dequeue.pos.load(std::memory_order_relaxed);
+
+		while(true)
+		{
+			Slot&    slot = slots.data()[pos & mask];
+			size_t   seq  = slot.sequence.load(std::memory_order_acquire);
+			intptr_t diff = static_cast<intptr_t>(seq - (pos + 1));
+
+			if(diff == 0)
+			{
+				if(dequeue.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					out = std::move(slot.value);
+					// Free the slot for the producer one lap ahead
+					slot.sequence.store(pos + mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if(diff < 0)
+			{
+				return false;
+			}
+			else
+			{
+				pos = dequeue.pos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	template<typename T> void MpmcQueue<T>::pop(T& out)
+	{
+		for(uint32_t spins = 0; !try_pop(out);)
+		{
+			hidden::backoff(spins);
+		}
+	}
+
+	// Claim up to max consecutive free slots starting at the enqueue index. Returns the first position in start
+	template<typename T> size_t MpmcQueue<T>::claim_push(size_t max, size_t& start)
+	{
+		size_t pos = enqueue.pos.load(std::memory_order_relaxed);
+
+		while(true)
+		{
+			size_t n = 0;
+
+			// Only the producer that claims a position can change its slot, so this run stays free until the swap
+			while(n < max && n <= mask && slots.data()[(pos + n) & mask].sequence.load(std::memory_order_acquire) == pos + n)
+			{
+				++n;
+			}
+
+			if(n == 0)
+			{
+				size_t seq = slots.data()[pos & mask].sequence.load(std::memory_order_acquire);
+
+				if(static_cast<intptr_t>(seq - pos) < 0)
+				{
+					return 0;
+				}
+
+				pos = enqueue.pos.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			if(enqueue.pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+			{
+				start = pos;
+				return n;
+			}
+		}
+	}
+
+	// Claim up to max consecutive filled slots starting at the dequeue index. Returns the first position in start
+	template<typename T> size_t MpmcQueue<T>::claim_pop(size_t max, size_t& start)
+	{
+		size_t pos = dequeue.pos.load(std::memory_order_relaxed);
+
+		while(true)
+		{
+			size_t n = 0;
+
+			while(n < max && n <= mask && slots.data()[(pos + n) & mask].sequence.load(std::memory_order_acquire) == pos + n + 1)
+			{
+				++n;
+			}
+
+			if(n == 0)
+			{
+				size_t seq = slots.data()[pos & mask].sequence.load(std::memory_order_acquire);
+
+				if(static_cast<intptr_t>(seq - (pos + 1)) < 0)
+				{
+					return 0;
+				}
+
+				pos = dequeue.pos.load(std::memory_order_relaxed);
+				continue;
+			}
+
+			if(dequeue.pos.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed))
+			{
+				start = pos;
+				return n;
+			}
+		}
+	}
+
+	template<typename T> size_t MpmcQueue<T>::try_push_bulk(ArrayPtr<const T> values)
+	{
+		size_t start = 0;
+		size_t n     = claim_push(values.size(), start);
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			Slot& slot = slots.data()[(start + i) & mask];
+			slot.value = values.data()[i];
+			slot.sequence.store(start + i + 1, std::memory_order_release);
+		}
+		return n;
+	}
+
+	template<typename T> void MpmcQueue<T>::push_bulk(ArrayPtr<const T> values)
+	{
+		size_t done = 0;
+
+		for(uint32_t spins = 0; done < values.size();)
+		{
+			size_t n = try_push_bulk(ArrayPtr<const T>{values.data() + done, values.size() - done});
+
+			if(n == 0)
+			{
+				hidden::backoff(spins);
+			}
+
+			done += n;
+		}
+	}
+
+	template<typename T> size_t MpmcQueue<T>::try_pop_bulk(ArrayPtr<T> out)
+	{
+		size_t start = 0;
+		size_t n     = claim_pop(out.size(), start);
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			Slot& slot        = slots.data()[(start + i) & mask];
+			out.data()[i]     = std::move(slot.value);
+			slot.sequence.store(start + i + mask + 1, std::memory_order_release);
+		}
+		return n;
+	}
+
+	template<typename T> size_t MpmcQueue<T>::pop_bulk(ArrayPtr<T> out)
+	{
+		size_t n = 0;
+
+		for(uint32_t spins = 0; out.size() && (n = try_pop_bulk(out)) == 0;)
+		{
+			hidden::backoff(spins);
+		}
+		return n;
+	}
+}
+// namespace::rcom
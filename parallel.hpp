@@ -0,0 +1,136 @@
+#pragma once
+
+// Parallel algorithms over ArrayPtr slices
+
+#include "thread_pool.hpp"
+
+// Bytes of elements handed to a task when no grain size is given
+#if !defined(RCOM_PARALLEL_GRAIN_BYTES)
+	#define RCOM_PARALLEL_GRAIN_BYTES (64 * 1024)
+#endif
+
+namespace rcom
+{
+	// Pool shared by the parallel algorithms, created on first use
+	inline ThreadPool& default_thread_pool()
+	{
+		static ThreadPool pool;
+		return pool;
+	}
+
+	namespace hidden
+	{
+		template<typename T> inline size_t grain_size(size_t grain)
+		{
+			if(grain)
+			{
+				return grain;
+			}
+
+			size_t n = RCOM_PARALLEL_GRAIN_BYTES / sizeof(T);
+			return n ? n : 1;
+		}
+
+		inline size_t chunk_count(size_t n, size_t grain)
+		{
+			return (n + grain - 1) / grain;
+		}
+
+		template<typename T> inline ArrayPtr<T> chunk(ArrayPtr<T> ptr, size_t i, size_t grain)
+		{
+			size_t start = i * grain;
+			size_t end   = start + grain < ptr.size() ? start + grain : ptr.size();
+			return ptr.slice(start, end);
+		}
+	}
+	// namespace hidden
+
+	// Call func(chunk) for consecutive slices of up to grain elements
+	template<typename T, typename Func> void parallel_for(ArrayPtr<T> ptr, Func func, size_t grain = 0, ThreadPool& pool = default_thread_pool())
+	{
+		if(ptr.size() == 0)
+		{
+			return;
+		}
+
+		grain = hidden::grain_size<T>(grain);
+
+		auto task = [&](size_t i)
+		{
+			func(hidden::chunk(ptr, i, grain));
+		};
+
+		pool.run(hidden::chunk_count(ptr.size(), grain), task);
+	}
+
+	// Reduce each slice with map(chunk), then combine the partial results in order with reduce(a, b)
+	template<typename T, typename R, typename Map, typename Reduce>
+	R parallel_reduce(ArrayPtr<T> ptr, R init, Map map, Reduce reduce, size_t grain = 0, ThreadPool& pool = default_thread_pool())
+	{
+		if(ptr.size() == 0)
+		{
+			return init;
+		}
+
+		grain = hidden::grain_size<T>(grain);
+
+		size_t          chunks = hidden::chunk_count(ptr.size(), grain);
+		DynamicArray<R> partials;
+
+		if(!partials.reserve(chunks))
+		{
+			// Out of memory, fall back to one chunk
+			return reduce(init, map(ptr));
+		}
+
+		for(size_t i = 0; i < chunks; ++i)
+		{
+			partials.push(init);
+		}
+
+		auto task = [&](size_t i)
+		{
+			partials[i] = map(hidden::chunk(ptr, i, grain));
+		};
+
+		pool.run(chunks, task);
+
+		R result = init;
+
+		for(const R& r : partials)
+		{
+			result = reduce(result, r);
+		}
+		return result;
+	}
+
+	// dst[i] = func(src[i])
+	template<typename T, typename U, typename Func>
+	void parallel_transform(ArrayPtr<T> src, ArrayPtr<U> dst, Func func, size_t grain = 0, ThreadPool& pool = default_thread_pool())
+	{
+		RCOM_ASSERT(dst.size() >= src.size(), "Array too small");
+
+		if(src.size() == 0)
+		{
+			return;
+		}
+
+		grain = hidden::grain_size<T>(grain);
+
+		auto task = [&](size_t i)
+		{
+			size_t start = i * grain;
+			size_t end   = start + grain < src.size() ? start + grain : src.size();
+			const T* s   = src.data();
+			U*       d   = dst.data();
+
+			for(size_t j = start; j < end; ++j)
+			{
+				d[j] = func(s[j]);
+			}
+		};
+
+		pool.run(hidden::chunk_count(src.size(), grain), task);
+	}
+}
+// namespace::rcom
@@ -0,0 +1,187 @@
+#pragma once
+
+// Fixed size object pool with an intrusive free list
+
+#include "dynamic_array.hpp"
+
+namespace rcom
+{
+	// Storage for one object. Holds the free list link while unused
+	template<typename T> struct PoolSlot
+	{
+		union
+		{
+			PoolSlot* next;
+			alignas(T) uint8_t storage[sizeof(T)];
+		};
+	};
+
+	template<typename T, size_t ChunkSize = 256, typename Alloc = MallocAllocator> class Pool
+	{
+	public:
+		static_assert(ChunkSize > 0, "Chunk must be of non zero size");
+
+		typedef PoolSlot<T> Slot;
+
+		inline Pool();
+		inline explicit Pool(Alloc a);
+		inline ~Pool();
+
+		Pool(const Pool&)            = delete;
+		Pool& operator=(const Pool&) = delete;
+
+		// Return nullptr if memory could not be allocated
+		template<typename... Args>
+		inline T*   create(Args&&... args);
+		inline void destroy(T* t);
+
+		// Raw slots. Objects are not constructed or destroyed
+		inline T*   allocate();
+		inline void deallocate(T* t);
+
+		// Add caller owned storage, for example an Array<PoolSlot<T>, N>. It is not freed by the pool
+		inline void add_chunk(ArrayPtr<Slot> chunk);
+		// Allocate a chunk up front. Return false if memory could not be allocated
+		inline bool reserve(size_t n);
+
+		inline size_t live()     const;
+		inline size_t capacity() const;
+		inline size_t chunks()   const;
+	private:
+		Slot*          free_list;
+		ArrayPtr<Slot> fresh;
+		size_t         live_count;
+		size_t         slot_count;
+		size_t         chunk_count;
+		Alloc          alloc;
+		DynamicArray<ArrayPtr<Slot>, GrowDouble, Alloc> owned;
+	};
+
+	template<typename T, size_t ChunkSize, typename Alloc> Pool<T, ChunkSize, Alloc>::Pool() :
+		Pool{Alloc{}}
+	{
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> Pool<T, ChunkSize, Alloc>::Pool(Alloc a) :
+		free_list{nullptr},
+		fresh{},
+		live_count{0},
+		slot_count{0},
+		chunk_count{0},
+		alloc{a},
+		owned{a}
+	{
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> Pool<T, ChunkSize, Alloc>::~Pool()
+	{
+		RCOM_ASSERT(live_count == 0, "Pool destroyed with live objects");
+
+		for(ArrayPtr<Slot> chunk : owned)
+		{
+			deallocate_array(alloc, chunk);
+		}
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc>
+	template<typename... Args> T* Pool<T, ChunkSize, Alloc>::create(Args&&... args)
+	{
+		T* t = allocate();
+		return t ? new(t) T(std::forward<Args>(args)...) : nullptr;
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> void Pool<T, ChunkSize, Alloc>::destroy(T* t)
+	{
+		RCOM_ASSERT(t, "Null pointer");
+
+		t->~T();
+		deallocate(t);
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> T* Pool<T, ChunkSize, Alloc>::allocate()
+	{
+		Slot* slot = free_list;
+
+		if(slot)
+		{
+			// Most recently freed slot first, it is likely still in cache
+			free_list = slot->next;
+		}
+		else
+		{
+			if(fresh.size() == 0 && !reserve(ChunkSize))
+			{
+				return nullptr;
+			}
+
+			// Carve new chunks in address order
+			slot  = fresh.data();
+			fresh = {slot + 1, fresh.size() - 1};
+		}
+
+		++live_count;
+		return reinterpret_cast<T*>(slot->storage);
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> void Pool<T, ChunkSize, Alloc>::deallocate(T* t)
+	{
+		RCOM_ASSERT(t, "Null pointer");
+		RCOM_ASSERT(live_count > 0, "Pool has no live objects");
+
+		Slot* slot = reinterpret_cast<Slot*>(t);
+		slot->next = free_list;
+		free_list  = slot;
+		--live_count;
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> void Pool<T, ChunkSize, Alloc>::add_chunk(ArrayPtr<Slot> chunk)
+	{
+		RCOM_ASSERT(chunk, "Null pointer");
+
+		// Keep whatever is left of the current chunk
+		for(Slot& slot : fresh)
+		{
+			slot.next = free_list;
+			free_list = &slot;
+		}
+
+		fresh       = chunk;
+		slot_count += chunk.size();
+		++chunk_count;
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> bool Pool<T, ChunkSize, Alloc>::reserve(size_t n)
+	{
+		ArrayPtr<Slot> chunk = allocate_array<Slot>(alloc, n);
+
+		if(!chunk)
+		{
+			return false;
+		}
+
+		if(!owned.push(chunk))
+		{
+			deallocate_array(alloc, chunk);
+			return false;
+		}
+
+		add_chunk(chunk);
+		return true;
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> size_t Pool<T, ChunkSize, Alloc>::live() const
+	{
+		return live_count;
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> size_t Pool<T, ChunkSize, Alloc>::capacity() const
+	{
+		return slot_count;
+	}
+
+	template<typename T, size_t ChunkSize, typename Alloc> size_t Pool<T, ChunkSize, Alloc>::chunks() const
+	{
+		return chunk_count;
+	}
+}
+// namespace::rcom
@@ -0,0 +1,314 @@
+#pragma once
+
+// LSD radix sort for integer and floating point keys, optionally carrying values
+//
+// Sorts a byte at a time into caller provided scratch, so it never allocates. Passes whose byte is the same for every key
+// are skipped, which makes keys with small ranges or shared high bits cheap. The sort is stable.
+// Floats sort in the order of operator<, with -0 before +0 and NaNs at the ends depending on their sign.
+
+#include "parallel.hpp"
+#include "array.hpp"
+#include <cstring>
+#include <type_traits>
+
+// Threads the parallel sort splits the keys between at most
+#if !defined(RCOM_RADIX_MAX_CHUNKS)
+	#define RCOM_RADIX_MAX_CHUNKS 32
+#endif
+
+// Keys below which the parallel sort runs serially
+#if !defined(RCOM_RADIX_PARALLEL_MIN)
+	#define RCOM_RADIX_PARALLEL_MIN (256 * 1024)
+#endif
+
+namespace rcom { namespace hidden
+{
+	// Unsigned type of the same size as T
+	template<size_t Size> struct RadixBits;
+	template<> struct RadixBits<1> { using Type = uint8_t;  };
+	template<> struct RadixBits<2> { using Type = uint16_t; };
+	template<> struct RadixBits<4> { using Type = uint32_t; };
+	template<> struct RadixBits<8> { using Type = uint64_t; };
+
+	// Map a key to unsigned bits whose unsigned order is the key's order
+	template<typename T, bool Float = std::is_floating_point<T>::value, bool Signed = std::is_signed<T>::value> struct RadixKey
+	{
+		using Bits = typename RadixBits<sizeof(T)>::Type;
+
+		static Bits encode(T key)
+		{
+			return static_cast<Bits>(key);
+		}
+	};
+
+	template<typename T> struct RadixKey<T, false, true>
+	{
+		using Bits = typename RadixBits<sizeof(T)>::Type;
+
+		static Bits encode(T key)
+		{
+			// Flip the sign bit so negatives come first
+			return static_cast<Bits>(static_cast<Bits>(key) ^ (Bits(1) << (sizeof(T) * 8 - 1)));
+		}
+	};
+
+	template<typename T> struct RadixKey<T, true, true>
+	{
+		using Bits = typename RadixBits<sizeof(T)>::Type;
+
+		static Bits encode(T key)
+		{
+			Bits bits;
+			std::memcpy(&bits, &key, sizeof(T));
+
+			// Negatives have every bit flipped so larger magnitudes come first, positives only the sign bit
+			Bits sign = Bits(1) << (sizeof(T) * 8 - 1);
+			return bits & sign ? Bits(~bits) : Bits(bits | sign);
+		}
+	};
+
+	// Stands in for the values array when only keys are sorted
+	struct RadixNoValue
+	{
+	};
+
+	using RadixCounts = Array<size_t, 256>;
+
+	template<typename T> inline size_t radix_digit(T key, size_t pass)
+	{
+		return static_cast<size_t>(RadixKey<T>::encode(key) >> (pass * 8)) & 0xff;
+	}
+
+	// Histogram of every digit of every key in one read
+	template<typename K> inline void radix_histograms(const K* keys, size_t n, RadixCounts* counts)
+	{
+		for(size_t p = 0; p < sizeof(K); ++p)
+		{
+			std::memset(counts[p].data(), 0, counts[p].byte_size());
+		}
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			typename RadixKey<K>::Bits bits = RadixKey<K>::encode(keys[i]);
+
+			for(size_t p = 0; p < sizeof(K); ++p)
+			{
+				++counts[p][(bits >> (p * 8)) & 0xff];
+			}
+		}
+	}
+
+	// True if every key has the same digit, so the pass would not move anything
+	inline bool radix_pass_trivial(const RadixCounts& counts, size_t n)
+	{
+		for(size_t c : counts)
+		{
+			if(c)
+			{
+				return c == n;
+			}
+		}
+		return true;
+	}
+
+	// Scatter keys and values into the positions in offsets, which are advanced
+	template<typename K, typename V> inline void radix_scatter(const K* src_keys, K* dst_keys, V* src_values, V* dst_values, size_t n, size_t pass, size_t* offsets)
+	{
+		const bool has_values = !std::is_same<V, RadixNoValue>::value;
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			size_t o    = offsets[radix_digit(src_keys[i], pass)]++;
+			dst_keys[o] = src_keys[i];
+
+			if(has_values)
+			{
+				dst_values[o] = std::move(src_values[i]);
+			}
+		}
+	}
+
+	// Put the result back in the caller's arrays if it ended in scratch
+	template<typename K, typename V> inline void radix_finish(K* keys, K* result_keys, V* values, V* result_values, size_t n)
+	{
+		const bool has_values = !std::is_same<V, RadixNoValue>::value;
+
+		if(result_keys == keys)
+		{
+			return;
+		}
+
+		std::memcpy(keys, result_keys, n * sizeof(K));
+
+		if(has_values)
+		{
+			for(size_t i = 0; i < n; ++i)
+			{
+				values[i] = std::move(result_values[i]);
+			}
+		}
+	}
+
+	template<typename K, typename V> inline void radix_sort(K* keys, K* key_scratch, V* values, V* value_scratch, size_t n)
+	{
+		static_assert(std::is_arithmetic<K>::value && !std::is_same<K, bool>::value, "Radix sort keys must be integers or floats");
+
+		RadixCounts counts[sizeof(K)];
+		radix_histograms(keys, n, counts);
+
+		K* src_keys   = keys;
+		K* dst_keys   = key_scratch;
+		V* src_values = values;
+		V* dst_values = value_scratch;
+
+		for(size_t p = 0; p < sizeof(K); ++p)
+		{
+			if(radix_pass_trivial(counts[p], n))
+			{
+				continue;
+			}
+
+			size_t offsets[256];
+			size_t sum = 0;
+
+			for(size_t d = 0; d < 256; ++d)
+			{
+				offsets[d]  = sum;
+				sum        += counts[p][d];
+			}
+
+			radix_scatter(src_keys, dst_keys, src_values, dst_values, n, p, offsets);
+			std::swap(src_keys,   dst_keys);
+			std::swap(src_values, dst_values);
+		}
+
+		radix_finish(keys, src_keys, values, src_values, n);
+	}
+
+	// Each chunk histograms its own slice, then scatters it to offsets placed after every earlier chunk's keys of the same digit
+	template<typename K, typename V> inline void parallel_radix_sort(K* keys, K* key_scratch, V* values, V* value_scratch, size_t n, ThreadPool& pool)
+	{
+		size_t chunks = pool.size() < RCOM_RADIX_MAX_CHUNKS ? pool.size() : RCOM_RADIX_MAX_CHUNKS;
+
+		if(chunks < 2 || n < RCOM_RADIX_PARALLEL_MIN)
+		{
+			radix_sort(keys, key_scratch, values, value_scratch, n);
+			return;
+		}
+
+		size_t      grain = (n + chunks - 1) / chunks;
+		RadixCounts counts[RCOM_RADIX_MAX_CHUNKS];
+
+		K* src_keys   = keys;
+		K* dst_keys   = key_scratch;
+		V* src_values = values;
+		V* dst_values = value_scratch;
+
+		for(size_t p = 0; p < sizeof(K); ++p)
+		{
+			auto histogram = [&](size_t c)
+			{
+				size_t start = c * grain;
+				size_t end   = start + grain < n ? start + grain : n;
+
+				std::memset(counts[c].data(), 0, counts[c].byte_size());
+
+				for(size_t i = start; i < end; ++i)
+				{
+					++counts[c][radix_digit(src_keys[i], p)];
+				}
+			};
+
+			pool.run(chunks, histogram);
+
+			// Digit totals do not change between passes, but checking here saves keeping a histogram per pass per chunk
+			RadixCounts total;
+			std::memset(total.data(), 0, total.byte_size());
+
+			for(size_t c = 0; c < chunks; ++c)
+			{
+				for(size_t d = 0; d < 256; ++d)
+				{
+					total[d] += counts[c][d];
+				}
+			}
+
+			if(radix_pass_trivial(total, n))
+			{
+				continue;
+			}
+
+			// Turn counts into each chunk's starting offset for each digit
+			size_t sum = 0;
+
+			for(size_t d = 0; d < 256; ++d)
+			{
+				for(size_t c = 0; c < chunks; ++c)
+				{
+					size_t count  = counts[c][d];
+					counts[c][d]  = sum;
+					sum          += count;
+				}
+			}
+
+			auto scatter = [&](size_t c)
+			{
+				size_t start = c * grain;
+				size_t end   = start + grain < n ? start + grain : n;
+
+				if(start < end)
+				{
+					V* sv = std::is_same<V, RadixNoValue>::value ? src_values : src_values + start;
+					radix_scatter(src_keys + start, dst_keys, sv, dst_values, end - start, p, counts[c].data());
+				}
+			};
+
+			pool.run(chunks, scatter);
+			std::swap(src_keys,   dst_keys);
+			std::swap(src_values, dst_values);
+		}
+
+		radix_finish(keys, src_keys, values, src_values, n);
+	}
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	// Sort keys in place. scratch must hold at least keys.size() elements
+	template<typename K> inline void radix_sort(ArrayPtr<K> keys, ArrayPtr<K> scratch)
+	{
+		RCOM_ASSERT(scratch.size() >= keys.size(), "Scratch too small");
+
+		hidden::radix_sort(keys.data(), scratch.data(), static_cast<hidden::RadixNoValue*>(nullptr), static_cast<hidden::RadixNoValue*>(nullptr), keys.size());
+	}
+
+	// Sort keys in place, moving values[i] along with keys[i]. Equal keys keep their order
+	template<typename K, typename V> inline void radix_sort(ArrayPtr<K> keys, ArrayPtr<V> values, ArrayPtr<K> key_scratch, ArrayPtr<V> value_scratch)
+	{
+		RCOM_ASSERT(values.size() == keys.size(),        "Keys and values differ in size");
+		RCOM_ASSERT(key_scratch.size() >= keys.size(),   "Scratch too small");
+		RCOM_ASSERT(value_scratch.size() >= keys.size(), "Scratch too small");
+
+		hidden::radix_sort(keys.data(), key_scratch.data(), values.data(), value_scratch.data(), keys.size());
+	}
+
+	// radix_sort with the histogram and scatter of each pass split across the pool
+	template<typename K> inline void parallel_radix_sort(ArrayPtr<K> keys, ArrayPtr<K> scratch, ThreadPool& pool = default_thread_pool())
+	{
+		RCOM_ASSERT(scratch.size() >= keys.size(), "Scratch too small");
+
+		hidden::parallel_radix_sort(keys.data(), scratch.data(), static_cast<hidden::RadixNoValue*>(nullptr), static_cast<hidden::RadixNoValue*>(nullptr), keys.size(), pool);
+	}
+
+	template<typename K, typename V>
+	inline void parallel_radix_sort(ArrayPtr<K> keys, ArrayPtr<V> values, ArrayPtr<K> key_scratch, ArrayPtr<V> value_scratch, ThreadPool& pool = default_thread_pool())
+	{
+		RCOM_ASSERT(values.size() == keys.size(),        "Keys and values differ in size");
+		RCOM_ASSERT(key_scratch.size() >= keys.size(),   "Scratch too small");
+		RCOM_ASSERT(value_scratch.size() >= keys.size(), "Scratch too small");
+
+		hidden::parallel_radix_sort(keys.data(), key_scratch.data(), values.data(), value_scratch.data(), keys.size(), pool);
+	}
+}
+// namespace::rcom
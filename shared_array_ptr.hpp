@@ -0,0 +1,343 @@
+#pragma once
+
+// Reference counted ArrayPtr
+//
+// The count, length and allocator sit in a header at the front of the same allocation as the elements,
+// so making one costs a single allocation and the handle itself is a single pointer.
+
+#include "allocator.hpp"
+#include <atomic>
+
+namespace rcom
+{
+	// Reference count policies
+
+	// Safe to copy and destroy handles on any thread
+	struct AtomicRefCount
+	{
+		std::atomic<size_t> refs;
+
+		inline void   init()          { refs.store(1, std::memory_order_relaxed); }
+		inline void   acquire()       { refs.fetch_add(1, std::memory_order_relaxed); }
+		// True when the last reference went away
+		inline bool   release()       { return refs.fetch_sub(1, std::memory_order_acq_rel) == 1; }
+		inline size_t count()   const { return refs.load(std::memory_order_relaxed); }
+	};
+
+	// Plain counter. Every handle to the array must stay on one thread
+	struct LocalRefCount
+	{
+		size_t refs;
+
+		inline void   init()          { refs = 1; }
+		inline void   acquire()       { ++refs; }
+		inline bool   release()       { return --refs == 0; }
+		inline size_t count()   const { return refs; }
+	};
+
+	template<typename T, typename RefCount = AtomicRefCount, typename Alloc = MallocAllocator> class SharedArrayPtr;
+
+	template<typename T, typename Alloc = MallocAllocator> using LocalSharedArrayPtr = SharedArrayPtr<T, LocalRefCount, Alloc>;
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	template<typename RefCount, typename Alloc> struct SharedArrayHeader
+	{
+		RefCount refs;
+		size_t   len;
+		Alloc    alloc;
+	};
+
+	// Elements start at the first suitably aligned offset after the header
+	template<typename T, typename Header> constexpr size_t shared_array_offset()
+	{
+		return (sizeof(Header) + alignof(T) - 1) / alignof(T) * alignof(T);
+	}
+
+	template<typename T, typename Header> constexpr size_t shared_array_align()
+	{
+		return alignof(T) > alignof(Header) ? alignof(T) : alignof(Header);
+	}
+
+	struct SharedArrayAccess;
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	template<typename T, typename RefCount, typename Alloc> class SharedArrayPtr
+	{
+	public:
+		inline SharedArrayPtr();
+		inline SharedArrayPtr(std::nullptr_t);
+		inline SharedArrayPtr(const SharedArrayPtr& other);
+		inline SharedArrayPtr(SharedArrayPtr&& other);
+		inline SharedArrayPtr& operator=(const SharedArrayPtr& other);
+		inline SharedArrayPtr& operator=(SharedArrayPtr&& other);
+		inline ~SharedArrayPtr();
+
+		// Share the same elements read only
+		inline operator SharedArrayPtr<const T, RefCount, Alloc>() const &;
+		inline operator SharedArrayPtr<const T, RefCount, Alloc>() &&;
+
+		inline operator ArrayPtr<T>()       const;
+		inline operator bool()              const;
+
+		// Read only view when T is not already const
+		template<typename U, typename = typename std::enable_if<std::is_same<U, const T>::value && !std::is_const<T>::value>::type>
+		inline operator ArrayPtr<U>() const
+		{
+			return to_ptr();
+		}
+
+		inline size_t size()      const;
+		inline size_t byte_size() const;
+		// Handles sharing the elements, 0 if null. Only a hint for atomic counts while other threads hold handles
+		inline size_t use_count() const;
+
+		inline ArrayPtr<T> to_ptr()   const;
+		inline BytePtr     to_bytes() const;
+
+		inline ArrayPtr<T> slice(size_t start, size_t end) const;
+		inline ArrayPtr<T> slice(size_t start) const;
+
+		inline T& operator[](size_t i) const;
+
+		inline T* data()  const;
+		inline T* begin() const;
+		inline T* end()   const;
+
+		// Drop this handle's reference, freeing the elements if it was the last
+		inline void reset();
+	private:
+		using Mutable = typename std::remove_const<T>::type;
+		using Header  = hidden::SharedArrayHeader<RefCount, Alloc>;
+
+		Header* header;
+
+		inline explicit SharedArrayPtr(Header* h);
+
+		template<typename U, typename R, typename A> friend class SharedArrayPtr;
+		friend struct hidden::SharedArrayAccess;
+	};
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	struct SharedArrayAccess
+	{
+		// Allocate the header and count uninitialized elements. Null if memory could not be allocated
+		template<typename T, typename RefCount, typename Alloc> static SharedArrayPtr<T, RefCount, Alloc> allocate(size_t count, Alloc a)
+		{
+			using Header = SharedArrayHeader<RefCount, Alloc>;
+
+			size_t  offset = shared_array_offset<T, Header>();
+			size_t  align  = shared_array_align<T, Header>();
+			BytePtr mem    = a.allocate(offset + ::byte_size<T>(count), align);
+
+			if(!mem)
+			{
+				return {};
+			}
+
+			Header* h = new(mem.data()) Header{};
+			h->refs.init();
+			h->len   = count;
+			h->alloc = a;
+			return SharedArrayPtr<T, RefCount, Alloc>{h};
+		}
+	};
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	// count value initialized elements. Null if memory could not be allocated
+	template<typename T, typename RefCount = AtomicRefCount, typename Alloc = MallocAllocator>
+	inline SharedArrayPtr<T, RefCount, Alloc> make_shared_array(size_t count, Alloc a = Alloc{})
+	{
+		SharedArrayPtr<T, RefCount, Alloc> p = hidden::SharedArrayAccess::allocate<T, RefCount>(count, a);
+
+		for(size_t i = 0; p && i < count; ++i)
+		{
+			new(&p.data()[i]) T();
+		}
+		return p;
+	}
+
+	// Copy of src. Null if memory could not be allocated
+	template<typename T, typename RefCount = AtomicRefCount, typename Alloc = MallocAllocator>
+	inline SharedArrayPtr<T, RefCount, Alloc> make_shared_array(ArrayPtr<const T> src, Alloc a = Alloc{})
+	{
+		SharedArrayPtr<T, RefCount, Alloc> p = hidden::SharedArrayAccess::allocate<T, RefCount>(src.size(), a);
+
+		for(size_t i = 0; p && i < src.size(); ++i)
+		{
+			new(&p.data()[i]) T(src.data()[i]);
+		}
+		return p;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::SharedArrayPtr() :
+		header{nullptr}
+	{
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::SharedArrayPtr(std::nullptr_t) :
+		header{nullptr}
+	{
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::SharedArrayPtr(Header* h) :
+		header{h}
+	{
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::SharedArrayPtr(const SharedArrayPtr& other) :
+		header{other.header}
+	{
+		if(header)
+		{
+			header->refs.acquire();
+		}
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::SharedArrayPtr(SharedArrayPtr&& other) :
+		header{other.header}
+	{
+		other.header = nullptr;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> auto SharedArrayPtr<T, RefCount, Alloc>::operator=(const SharedArrayPtr& other) -> SharedArrayPtr&
+	{
+		// Acquire first so assigning a handle to itself does not free the elements
+		Header* h = other.header;
+
+		if(h)
+		{
+			h->refs.acquire();
+		}
+
+		reset();
+		header = h;
+		return *this;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> auto SharedArrayPtr<T, RefCount, Alloc>::operator=(SharedArrayPtr&& other) -> SharedArrayPtr&
+	{
+		if(this != &other)
+		{
+			reset();
+			header       = other.header;
+			other.header = nullptr;
+		}
+		return *this;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::~SharedArrayPtr()
+	{
+		reset();
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::operator SharedArrayPtr<const T, RefCount, Alloc>() const &
+	{
+		if(header)
+		{
+			header->refs.acquire();
+		}
+		return SharedArrayPtr<const T, RefCount, Alloc>{header};
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::operator SharedArrayPtr<const T, RefCount, Alloc>() &&
+	{
+		Header* h = header;
+		header    = nullptr;
+		return SharedArrayPtr<const T, RefCount, Alloc>{h};
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::operator ArrayPtr<T>() const
+	{
+		return to_ptr();
+	}
+
+	template<typename T, typename RefCount, typename Alloc> SharedArrayPtr<T, RefCount, Alloc>::operator bool() const
+	{
+		return header != nullptr;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> size_t SharedArrayPtr<T, RefCount, Alloc>::size() const
+	{
+		return header ? header->len : 0;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> size_t SharedArrayPtr<T, RefCount, Alloc>::byte_size() const
+	{
+		return ::byte_size<T>(size());
+	}
+
+	template<typename T, typename RefCount, typename Alloc> size_t SharedArrayPtr<T, RefCount, Alloc>::use_count() const
+	{
+		return header ? header->refs.count() : 0;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> ArrayPtr<T> SharedArrayPtr<T, RefCount, Alloc>::to_ptr() const
+	{
+		return {data(), size()};
+	}
+
+	template<typename T, typename RefCount, typename Alloc> BytePtr SharedArrayPtr<T, RefCount, Alloc>::to_bytes() const
+	{
+		return {reinterpret_cast<uint8_t*>(const_cast<Mutable*>(data())), byte_size()};
+	}
+
+	template<typename T, typename RefCount, typename Alloc> ArrayPtr<T> SharedArrayPtr<T, RefCount, Alloc>::slice(size_t start, size_t end) const
+	{
+		return to_ptr().slice(start, end);
+	}
+
+	template<typename T, typename RefCount, typename Alloc> ArrayPtr<T> SharedArrayPtr<T, RefCount, Alloc>::slice(size_t start) const
+	{
+		return to_ptr().slice(start);
+	}
+
+	template<typename T, typename RefCount, typename Alloc> T& SharedArrayPtr<T, RefCount, Alloc>::operator[](size_t i) const
+	{
+		RCOM_ASSERT(i < size(), "Index out of range");
+		return data()[i];
+	}
+
+	template<typename T, typename RefCount, typename Alloc> T* SharedArrayPtr<T, RefCount, Alloc>::data() const
+	{
+		return header ? reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(header) + hidden::shared_array_offset<T, Header>()) : nullptr;
+	}
+
+	template<typename T, typename RefCount, typename Alloc> T* SharedArrayPtr<T, RefCount, Alloc>::begin() const
+	{
+		return data();
+	}
+
+	template<typename T, typename RefCount, typename Alloc> T* SharedArrayPtr<T, RefCount, Alloc>::end() const
+	{
+		return data() + size();
+	}
+
+	template<typename T, typename RefCount, typename Alloc> void SharedArrayPtr<T, RefCount, Alloc>::reset()
+	{
+		if(header && header->refs.release())
+		{
+			size_t  len   = header->len;
+			Alloc   alloc = header->alloc;
+			BytePtr mem   = {reinterpret_cast<uint8_t*>(header), hidden::shared_array_offset<T, Header>() + ::byte_size<T>(len)};
+
+			hidden::destroy(const_cast<Mutable*>(data()), len);
+			header->~Header();
+			alloc.deallocate(mem, hidden::shared_array_align<T, Header>());
+		}
+
+		header = nullptr;
+	}
+}
+// namespace::rcom
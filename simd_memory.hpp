@@ -0,0 +1,195 @@
+#pragma once
+
+// Bulk memory kernels used by the ArrayPtr helper functions
+// Streaming stores bypass the cache, use them for buffers much larger than the last level cache
+
+#include "cpu.hpp"
+#include <cstring>
+
+namespace rcom { namespace hidden
+{
+	// Below this many bytes streaming is not worth the fence
+	constexpr const size_t stream_min_bytes = 4096;
+
+#if defined(RCOM_X86)
+	RCOM_TARGET("sse2") inline void stream_copy_sse2(uint8_t* dst, const uint8_t* src, size_t n)
+	{
+		size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+		memcpy(dst, src, head);
+
+		size_t i = head;
+
+		for(; i + 64 <= n; i += 64)
+		{
+			__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i +  0));
+			__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16));
+			__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 32));
+			__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 48));
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i +  0), a);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 16), b);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 32), c);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 48), d);
+		}
+
+		// Streaming stores are weakly ordered
+		_mm_sfence();
+		memcpy(dst + i, src + i, n - i);
+	}
+
+	RCOM_TARGET("avx2") inline void stream_copy_avx2(uint8_t* dst, const uint8_t* src, size_t n)
+	{
+		size_t head = (32 - (reinterpret_cast<uintptr_t>(dst) & 31)) & 31;
+		memcpy(dst, src, head);
+
+		size_t i = head;
+
+		for(; i + 128 <= n; i += 128)
+		{
+			__m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i +  0));
+			__m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32));
+			__m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 64));
+			__m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 96));
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i +  0), a);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32), b);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 64), c);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 96), d);
+		}
+
+		_mm_sfence();
+		memcpy(dst + i, src + i, n - i);
+	}
+
+	RCOM_TARGET("sse2") inline void stream_set_sse2(uint8_t* dst, int val, size_t n)
+	{
+		size_t head = (16 - (reinterpret_cast<uintptr_t>(dst) & 15)) & 15;
+		memset(dst, val, head);
+
+		const __m128i v = _mm_set1_epi8(static_cast<char>(val));
+		size_t i = head;
+
+		for(; i + 64 <= n; i += 64)
+		{
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i +  0), v);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 16), v);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 32), v);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(dst + i + 48), v);
+		}
+
+		_mm_sfence();
+		memset(dst + i, val, n - i);
+	}
+
+	RCOM_TARGET("avx2") inline void stream_set_avx2(uint8_t* dst, int val, size_t n)
+	{
+		size_t head = (32 - (reinterpret_cast<uintptr_t>(dst) & 31)) & 31;
+		memset(dst, val, head);
+
+		const __m256i v = _mm256_set1_epi8(static_cast<char>(val));
+		size_t i = head;
+
+		for(; i + 128 <= n; i += 128)
+		{
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i +  0), v);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 32), v);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 64), v);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(dst + i + 96), v);
+		}
+
+		_mm_sfence();
+		memset(dst + i, val, n - i);
+	}
+
+	// Equality only, stops at the first differing block
+	RCOM_TARGET("sse2") inline bool equal_bytes_sse2(const uint8_t* a, const uint8_t* b, size_t n)
+	{
+		size_t i = 0;
+
+		for(; i + 64 <= n; i += 64)
+		{
+			__m128i x0 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i +  0)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i +  0)));
+			__m128i x1 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16)));
+			__m128i x2 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 32)));
+			__m128i x3 = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 48)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 48)));
+			__m128i x  = _mm_and_si128(_mm_and_si128(x0, x1), _mm_and_si128(x2, x3));
+
+			if(_mm_movemask_epi8(x) != 0xFFFF)
+			{
+				return false;
+			}
+		}
+		return memcmp(a + i, b + i, n - i) == 0;
+	}
+
+	RCOM_TARGET("avx2") inline bool equal_bytes_avx2(const uint8_t* a, const uint8_t* b, size_t n)
+	{
+		size_t i = 0;
+
+		for(; i + 128 <= n; i += 128)
+		{
+			__m256i x0 = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i +  0)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i +  0)));
+			__m256i x1 = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32)));
+			__m256i x2 = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 64)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 64)));
+			__m256i x3 = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 96)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 96)));
+			__m256i x  = _mm256_or_si256(_mm256_or_si256(x0, x1), _mm256_or_si256(x2, x3));
+
+			if(!_mm256_testz_si256(x, x))
+			{
+				return false;
+			}
+		}
+		return memcmp(a + i, b + i, n - i) == 0;
+	}
+#endif
+
+	inline void stream_copy(uint8_t* dst, const uint8_t* src, size_t n)
+	{
+#if defined(RCOM_X86)
+		if(n >= stream_min_bytes)
+		{
+			if(cpu_supports(cpu_avx2))
+			{
+				return stream_copy_avx2(dst, src, n);
+			}
+			if(cpu_supports(cpu_sse2))
+			{
+				return stream_copy_sse2(dst, src, n);
+			}
+		}
+#endif
+		memcpy(dst, src, n);
+	}
+
+	inline void stream_set(uint8_t* dst, int val, size_t n)
+	{
+#if defined(RCOM_X86)
+		if(n >= stream_min_bytes)
+		{
+			if(cpu_supports(cpu_avx2))
+			{
+				return stream_set_avx2(dst, val, n);
+			}
+			if(cpu_supports(cpu_sse2))
+			{
+				return stream_set_sse2(dst, val, n);
+			}
+		}
+#endif
+		memset(dst, val, n);
+	}
+
+	inline bool equal_bytes(const uint8_t* a, const uint8_t* b, size_t n)
+	{
+#if defined(RCOM_X86)
+		if(cpu_supports(cpu_avx2))
+		{
+			return equal_bytes_avx2(a, b, n);
+		}
+		if(cpu_supports(cpu_sse2))
+		{
+			return equal_bytes_sse2(a, b, n);
+		}
+#endif
+		return memcmp(a, b, n) == 0;
+	}
+}}
+// namespace rcom::hidden
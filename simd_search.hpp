@@ -0,0 +1,373 @@
+#pragma once
+
+// Search kernels used by the ArrayPtr helper functions
+// Arithmetic element types are scanned a register at a time, picking SSE2 or AVX2 at runtime
+
+#include "cpu.hpp"
+#include <cstring>
+#include <type_traits>
+
+namespace rcom { namespace hidden
+{
+	// Type used to compare T in registers. void if T has no vector path
+	template<typename T, bool = std::is_integral<T>::value, size_t = sizeof(T)> struct SimdKind { typedef void type; };
+	template<typename T> struct SimdKind<T, true, 1> { typedef uint8_t  type; };
+	template<typename T> struct SimdKind<T, true, 2> { typedef uint16_t type; };
+	template<typename T> struct SimdKind<T, true, 4> { typedef uint32_t type; };
+	template<typename T> struct SimdKind<T, true, 8> { typedef uint64_t type; };
+	template<>           struct SimdKind<float,  false, 4> { typedef float  type; };
+	template<>           struct SimdKind<double, false, 8> { typedef double type; };
+
+	// Scalar fallbacks. Every search returns n if nothing was found
+	template<typename T> inline size_t find_scalar(const T* p, size_t n, const T& value, bool equal)
+	{
+		for(size_t i = 0; i < n; ++i)
+		{
+			if((p[i] == value) == equal)
+			{
+				return i;
+			}
+		}
+		return n;
+	}
+
+	template<typename T> inline size_t count_scalar(const T* p, size_t n, const T& value)
+	{
+		size_t c = 0;
+
+		for(size_t i = 0; i < n; ++i)
+		{
+			c += p[i] == value;
+		}
+		return c;
+	}
+
+	template<typename T> inline size_t find_all_scalar(const T* p, size_t n, const T& value, size_t base, size_t* out, size_t max)
+	{
+		size_t c = 0;
+
+		for(size_t i = 0; i < n && c < max; ++i)
+		{
+			if(p[i] == value)
+			{
+				out[c++] = base + i;
+			}
+		}
+		return c;
+	}
+
+#if defined(RCOM_X86)
+	// Lowest bit of each element in a byte mask
+	template<typename K> inline constexpr uint32_t lead_bits()
+	{
+		return sizeof(K) == 1 ? 0xFFFFFFFF : sizeof(K) == 2 ? 0x55555555 : sizeof(K) == 4 ? 0x11111111 : 0x01010101;
+	}
+
+	// Broadcast a value to every lane
+	RCOM_TARGET("sse2") inline __m128i splat_sse2(uint8_t  v) { return _mm_set1_epi8(static_cast<char>(v)); }
+	RCOM_TARGET("sse2") inline __m128i splat_sse2(uint16_t v) { return _mm_set1_epi16(static_cast<short>(v)); }
+	RCOM_TARGET("sse2") inline __m128i splat_sse2(uint32_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+	RCOM_TARGET("sse2") inline __m128i splat_sse2(uint64_t v) { return _mm_set1_epi64x(static_cast<long long>(v)); }
+	RCOM_TARGET("sse2") inline __m128i splat_sse2(float    v) { return _mm_castps_si128(_mm_set1_ps(v)); }
+	RCOM_TARGET("sse2") inline __m128i splat_sse2(double   v) { return _mm_castpd_si128(_mm_set1_pd(v)); }
+
+	// Compare lanes for equality. One bit per byte, all bits of an element set on a match
+	RCOM_TARGET("sse2") inline uint32_t equal_sse2(__m128i a, __m128i b, uint8_t)
+	{
+		return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+	}
+
+	RCOM_TARGET("sse2") inline uint32_t equal_sse2(__m128i a, __m128i b, uint16_t)
+	{
+		return _mm_movemask_epi8(_mm_cmpeq_epi16(a, b));
+	}
+
+	RCOM_TARGET("sse2") inline uint32_t equal_sse2(__m128i a, __m128i b, uint32_t)
+	{
+		return _mm_movemask_epi8(_mm_cmpeq_epi32(a, b));
+	}
+
+	RCOM_TARGET("sse2") inline uint32_t equal_sse2(__m128i a, __m128i b, uint64_t)
+	{
+		// No 64 bit compare in SSE2, both halves must match
+		__m128i c = _mm_cmpeq_epi32(a, b);
+		return _mm_movemask_epi8(_mm_and_si128(c, _mm_shuffle_epi32(c, _MM_SHUFFLE(2, 3, 0, 1))));
+	}
+
+	RCOM_TARGET("sse2") inline uint32_t equal_sse2(__m128i a, __m128i b, float)
+	{
+		return _mm_movemask_epi8(_mm_castps_si128(_mm_cmpeq_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))));
+	}
+
+	RCOM_TARGET("sse2") inline uint32_t equal_sse2(__m128i a, __m128i b, double)
+	{
+		return _mm_movemask_epi8(_mm_castpd_si128(_mm_cmpeq_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))));
+	}
+
+	RCOM_TARGET("avx2") inline __m256i splat_avx2(uint8_t  v) { return _mm256_set1_epi8(static_cast<char>(v)); }
+	RCOM_TARGET("avx2") inline __m256i splat_avx2(uint16_t v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+	RCOM_TARGET("avx2") inline __m256i splat_avx2(uint32_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+	RCOM_TARGET("avx2") inline __m256i splat_avx2(uint64_t v) { return _mm256_set1_epi64x(static_cast<long long>(v)); }
+	RCOM_TARGET("avx2") inline __m256i splat_avx2(float    v) { return _mm256_castps_si256(_mm256_set1_ps(v)); }
+	RCOM_TARGET("avx2") inline __m256i splat_avx2(double   v) { return _mm256_castpd_si256(_mm256_set1_pd(v)); }
+
+	RCOM_TARGET("avx2") inline __m256i equal_avx2(__m256i a, __m256i b, uint8_t)  { return _mm256_cmpeq_epi8(a, b); }
+	RCOM_TARGET("avx2") inline __m256i equal_avx2(__m256i a, __m256i b, uint16_t) { return _mm256_cmpeq_epi16(a, b); }
+	RCOM_TARGET("avx2") inline __m256i equal_avx2(__m256i a, __m256i b, uint32_t) { return _mm256_cmpeq_epi32(a, b); }
+	RCOM_TARGET("avx2") inline __m256i equal_avx2(__m256i a, __m256i b, uint64_t) { return _mm256_cmpeq_epi64(a, b); }
+
+	RCOM_TARGET("avx2") inline __m256i equal_avx2(__m256i a, __m256i b, float)
+	{
+		return _mm256_castps_si256(_mm256_cmp_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b), _CMP_EQ_OQ));
+	}
+
+	RCOM_TARGET("avx2") inline __m256i equal_avx2(__m256i a, __m256i b, double)
+	{
+		return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_castsi256_pd(a), _mm256_castsi256_pd(b), _CMP_EQ_OQ));
+	}
+
+	RCOM_TARGET("avx2") inline uint32_t mask_avx2(__m256i m)
+	{
+		return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+	}
+
+	template<typename K> RCOM_TARGET("sse2") size_t find_sse2(const K* p, size_t n, K value, bool equal)
+	{
+		const size_t   lanes  = 16 / sizeof(K);
+		const uint32_t invert = equal ? 0 : 0xFFFF;
+		const __m128i  needle = splat_sse2(value);
+
+		size_t i = 0;
+
+		for(; i + lanes <= n; i += lanes)
+		{
+			uint32_t mask = equal_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), needle, K{}) ^ invert;
+
+			if(mask)
+			{
+				return i + __builtin_ctz(mask) / sizeof(K);
+			}
+		}
+		return i + find_scalar(p + i, n - i, value, equal);
+	}
+
+	template<typename K> RCOM_TARGET("sse2") size_t count_sse2(const K* p, size_t n, K value)
+	{
+		const size_t  lanes  = 16 / sizeof(K);
+		const __m128i needle = splat_sse2(value);
+
+		size_t c = 0;
+		size_t i = 0;
+
+		for(; i + lanes <= n; i += lanes)
+		{
+			c += __builtin_popcount(equal_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), needle, K{}));
+		}
+		return c / sizeof(K) + count_scalar(p + i, n - i, value);
+	}
+
+	template<typename K> RCOM_TARGET("sse2") size_t find_all_sse2(const K* p, size_t n, K value, size_t* out, size_t max)
+	{
+		const size_t  lanes  = 16 / sizeof(K);
+		const __m128i needle = splat_sse2(value);
+
+		size_t c = 0;
+		size_t i = 0;
+
+		for(; i + lanes <= n; i += lanes)
+		{
+			uint32_t mask = equal_sse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), needle, K{}) & lead_bits<K>();
+
+			while(mask)
+			{
+				if(c == max)
+				{
+					return c;
+				}
+				out[c++] = i + __builtin_ctz(mask) / sizeof(K);
+				mask    &= mask - 1;
+			}
+		}
+		return c + find_all_scalar(p + i, n - i, value, i, out + c, max - c);
+	}
+
+	template<typename K> RCOM_TARGET("avx2") size_t find_avx2(const K* p, size_t n, K value, bool equal)
+	{
+		const size_t  lanes  = 32 / sizeof(K);
+		const __m256i needle = splat_avx2(value);
+		const __m256i invert = equal ? _mm256_setzero_si256() : _mm256_set1_epi8(-1);
+
+		size_t i = 0;
+
+		// Four registers per iteration, only locate the element once something matched
+		for(; i + 4 * lanes <= n; i += 4 * lanes)
+		{
+			const __m256i* v = reinterpret_cast<const __m256i*>(p + i);
+			__m256i a = _mm256_xor_si256(equal_avx2(_mm256_loadu_si256(v + 0), needle, K{}), invert);
+			__m256i b = _mm256_xor_si256(equal_avx2(_mm256_loadu_si256(v + 1), needle, K{}), invert);
+			__m256i c = _mm256_xor_si256(equal_avx2(_mm256_loadu_si256(v + 2), needle, K{}), invert);
+			__m256i d = _mm256_xor_si256(equal_avx2(_mm256_loadu_si256(v + 3), needle, K{}), invert);
+
+			if(mask_avx2(_mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d))))
+			{
+				uint32_t m;
+				if((m = mask_avx2(a))) return i + 0 * lanes + __builtin_ctz(m) / sizeof(K);
+				if((m = mask_avx2(b))) return i + 1 * lanes + __builtin_ctz(m) / sizeof(K);
+				if((m = mask_avx2(c))) return i + 2 * lanes + __builtin_ctz(m) / sizeof(K);
+				m = mask_avx2(d);
+				return i + 3 * lanes + __builtin_ctz(m) / sizeof(K);
+			}
+		}
+
+		for(; i + lanes <= n; i += lanes)
+		{
+			uint32_t m = mask_avx2(_mm256_xor_si256(equal_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), needle, K{}), invert));
+
+			if(m)
+			{
+				return i + __builtin_ctz(m) / sizeof(K);
+			}
+		}
+		return i + find_scalar(p + i, n - i, value, equal);
+	}
+
+	template<typename K> RCOM_TARGET("avx2,popcnt") size_t count_avx2(const K* p, size_t n, K value)
+	{
+		const size_t  lanes  = 32 / sizeof(K);
+		const __m256i needle = splat_avx2(value);
+
+		size_t c = 0;
+		size_t i = 0;
+
+		for(; i + lanes <= n; i += lanes)
+		{
+			c += _mm_popcnt_u32(mask_avx2(equal_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), needle, K{})));
+		}
+		return c / sizeof(K) + count_scalar(p + i, n - i, value);
+	}
+
+	template<typename K> RCOM_TARGET("avx2") size_t find_all_avx2(const K* p, size_t n, K value, size_t* out, size_t max)
+	{
+		const size_t  lanes  = 32 / sizeof(K);
+		const __m256i needle = splat_avx2(value);
+
+		size_t c = 0;
+		size_t i = 0;
+
+		for(; i + lanes <= n; i += lanes)
+		{
+			uint32_t mask = mask_avx2(equal_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)), needle, K{})) & lead_bits<K>();
+
+			while(mask)
+			{
+				if(c == max)
+				{
+					return c;
+				}
+				out[c++] = i + __builtin_ctz(mask) / sizeof(K);
+				mask    &= mask - 1;
+			}
+		}
+		return c + find_all_scalar(p + i, n - i, value, i, out + c, max - c);
+	}
+#endif
+
+	// Reinterpret an element as its register type
+	template<typename K, typename T> inline K to_kind(const T& value)
+	{
+		K k;
+		memcpy(&k, &value, sizeof(K));
+		return k;
+	}
+
+	template<typename T> inline size_t find(const T* p, size_t n, const T& value, bool equal, std::true_type)
+	{
+		return find_scalar(p, n, value, equal);
+	}
+
+	template<typename T> inline size_t find(const T* p, size_t n, const T& value, bool equal, std::false_type)
+	{
+#if defined(RCOM_X86)
+		typedef typename SimdKind<typename std::remove_cv<T>::type>::type K;
+		const K* k = reinterpret_cast<const K*>(p);
+
+		if(cpu_supports(cpu_avx2))
+		{
+			return find_avx2(k, n, to_kind<K>(value), equal);
+		}
+		if(cpu_supports(cpu_sse2))
+		{
+			return find_sse2(k, n, to_kind<K>(value), equal);
+		}
+#endif
+		return find_scalar(p, n, value, equal);
+	}
+
+	template<typename T> inline size_t count(const T* p, size_t n, const T& value, std::true_type)
+	{
+		return count_scalar(p, n, value);
+	}
+
+	template<typename T> inline size_t count(const T* p, size_t n, const T& value, std::false_type)
+	{
+#if defined(RCOM_X86)
+		typedef typename SimdKind<typename std::remove_cv<T>::type>::type K;
+		const K* k = reinterpret_cast<const K*>(p);
+
+		if(cpu_supports(cpu_avx2 | cpu_popcnt))
+		{
+			return count_avx2(k, n, to_kind<K>(value));
+		}
+		if(cpu_supports(cpu_sse2))
+		{
+			return count_sse2(k, n, to_kind<K>(value));
+		}
+#endif
+		return count_scalar(p, n, value);
+	}
+
+	template<typename T> inline size_t find_all(const T* p, size_t n, const T& value, size_t* out, size_t max, std::true_type)
+	{
+		return find_all_scalar(p, n, value, 0, out, max);
+	}
+
+	template<typename T> inline size_t find_all(const T* p, size_t n, const T& value, size_t* out, size_t max, std::false_type)
+	{
+#if defined(RCOM_X86)
+		typedef typename SimdKind<typename std::remove_cv<T>::type>::type K;
+		const K* k = reinterpret_cast<const K*>(p);
+
+		if(cpu_supports(cpu_avx2))
+		{
+			return find_all_avx2(k, n, to_kind<K>(value), out, max);
+		}
+		if(cpu_supports(cpu_sse2))
+		{
+			return find_all_sse2(k, n, to_kind<K>(value), out, max);
+		}
+#endif
+		return find_all_scalar(p, n, value, 0, out, max);
+	}
+
+	// True if T has no vector path
+	template<typename T> using IsScalar = std::is_void<typename SimdKind<typename std::remove_cv<T>::type>::type>;
+
+	// Index of the first element equal (or not equal) to value
+	template<typename T> inline size_t find(const T* p, size_t n, const T& value, bool equal)
+	{
+		return hidden::find(p, n, value, equal, IsScalar<T>{});
+	}
+
+	// Number of elements equal to value
+	template<typename T> inline size_t count(const T* p, size_t n, const T& value)
+	{
+		return hidden::count(p, n, value, IsScalar<T>{});
+	}
+
+	// Write indices of up to max elements equal to value. Return the number written
+	template<typename T> inline size_t find_all(const T* p, size_t n, const T& value, size_t* out, size_t max)
+	{
+		return hidden::find_all(p, n, value, out, max, IsScalar<T>{});
+	}
+}}
+// namespace rcom::hidden
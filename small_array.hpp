@@ -0,0 +1,444 @@
+#pragma once
+
+// Dynamic array which keeps its first N elements inline and only allocates past that
+
+#include "dynamic_array.hpp"
+#include "array.hpp"
+
+namespace rcom
+{
+	// Same interface as DynamicArray. The inline elements move with the SmallArray, so moving one is O(N) while it is inline
+	template<typename T, size_t N, typename Growth = GrowDouble, typename Alloc = MallocAllocator> class SmallArray
+	{
+	public:
+		static_assert(N > 0, "Inline capacity must be non zero");
+
+		inline SmallArray();
+		inline explicit SmallArray(Alloc a);
+		inline SmallArray(SmallArray&& other);
+		inline SmallArray& operator=(SmallArray&& other);
+		inline ~SmallArray();
+
+		SmallArray(const SmallArray&)            = delete;
+		SmallArray& operator=(const SmallArray&) = delete;
+
+		inline size_t size()      const;
+		inline size_t capacity()  const;
+		inline size_t byte_size() const;
+		// True while the elements are in the inline storage
+		inline bool   is_inline() const;
+
+		inline       Alloc& allocator();
+		inline const Alloc& allocator() const;
+
+		inline operator ArrayPtr<T>();
+		inline operator ArrayPtr<const T>() const;
+
+		inline ArrayPtr<T>             to_ptr();
+		inline ArrayPtr<const T>       to_ptr() const;
+		inline BytePtr                 to_bytes();
+		inline ArrayPtr<const uint8_t> to_bytes() const;
+
+		inline ArrayPtr<const T> slice(size_t start, size_t end) const;
+		inline ArrayPtr<T>       slice(size_t start, size_t end);
+		inline ArrayPtr<const T> slice(size_t start) const;
+		inline ArrayPtr<T>       slice(size_t start);
+
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start, size_t end) const;
+		inline BytePtr                 byte_slice(size_t start, size_t end);
+		inline ArrayPtr<const uint8_t> byte_slice(size_t start) const;
+		inline BytePtr                 byte_slice(size_t start);
+
+		inline       T&  operator[](size_t i);
+		inline const T&  operator[](size_t i)  const;
+
+		inline       T*  data();
+		inline const T*  data()  const;
+		inline       T*  begin();
+		inline const T*  begin() const;
+		inline       T*  end();
+		inline const T*  end()   const;
+		inline       T&  first();
+		inline const T&  first() const;
+		inline       T&  last();
+		inline const T&  last()  const;
+
+		// Return nullptr if memory could not be allocated
+		inline T* push(const T& value);
+		inline T* push(T&& value);
+		template<typename... Args>
+		inline T* emplace(Args&&... args);
+		inline void pop();
+
+		// Return false if memory could not be allocated
+		inline bool reserve(size_t n);
+		inline bool resize(size_t n);
+		inline void clear();
+	private:
+		// Elements are constructed one at a time, never the whole Array
+		union Inline
+		{
+			Array<T, N> arr;
+
+			Inline()  {}
+			~Inline() {}
+		};
+
+		ArrayPtr<T> buffer;
+		size_t      count;
+		Alloc       alloc;
+		Inline      local;
+
+		inline bool grow(size_t required);
+		inline bool set_capacity(size_t n);
+		inline void take(SmallArray& other);
+		inline void release();
+	};
+
+	template<typename T, size_t N, typename Growth, typename Alloc> SmallArray<T, N, Growth, Alloc>::SmallArray() :
+		buffer{local.arr.data(), N},
+		count{0},
+		alloc{}
+	{
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> SmallArray<T, N, Growth, Alloc>::SmallArray(Alloc a) :
+		buffer{local.arr.data(), N},
+		count{0},
+		alloc{a}
+	{
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> SmallArray<T, N, Growth, Alloc>::SmallArray(SmallArray&& other) :
+		buffer{local.arr.data(), N},
+		count{0},
+		alloc{other.alloc}
+	{
+		take(other);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> auto SmallArray<T, N, Growth, Alloc>::operator=(SmallArray&& other) -> SmallArray&
+	{
+		if(this != &other)
+		{
+			release();
+			alloc = other.alloc;
+			take(other);
+		}
+		return *this;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> SmallArray<T, N, Growth, Alloc>::~SmallArray()
+	{
+		release();
+	}
+
+	// Steal a heap buffer, or relocate inline elements into our own inline storage. Expects this to be empty and inline
+	template<typename T, size_t N, typename Growth, typename Alloc> void SmallArray<T, N, Growth, Alloc>::take(SmallArray& other)
+	{
+		if(other.is_inline())
+		{
+			hidden::relocate(local.arr.data(), other.buffer.data(), other.count);
+		}
+		else
+		{
+			buffer       = other.buffer;
+			other.buffer = {other.local.arr.data(), N};
+		}
+
+		count       = other.count;
+		other.count = 0;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> void SmallArray<T, N, Growth, Alloc>::release()
+	{
+		hidden::destroy(buffer.data(), count);
+
+		if(!is_inline())
+		{
+			deallocate_array(alloc, buffer);
+		}
+
+		buffer = {local.arr.data(), N};
+		count  = 0;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> bool SmallArray<T, N, Growth, Alloc>::grow(size_t required)
+	{
+		return set_capacity(Growth::grow(buffer.size(), required));
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> bool SmallArray<T, N, Growth, Alloc>::set_capacity(size_t n)
+	{
+		if(is_trivially_relocatable<T>::value && !is_inline())
+		{
+			// Let the allocator move the block, possibly without copying
+			BytePtr mem = alloc.reallocate(buffer.to_bytes(), ::byte_size<T>(n), alignof(T));
+
+			if(!mem)
+			{
+				return false;
+			}
+
+			buffer = {reinterpret_cast<T*>(mem.data()), n};
+			return true;
+		}
+
+		ArrayPtr<T> mem = allocate_array<T>(alloc, n);
+
+		if(!mem)
+		{
+			return false;
+		}
+
+		hidden::relocate(mem.data(), buffer.data(), count);
+
+		if(!is_inline())
+		{
+			deallocate_array(alloc, buffer);
+		}
+
+		buffer = mem;
+		return true;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> bool SmallArray<T, N, Growth, Alloc>::reserve(size_t n)
+	{
+		return n <= buffer.size() || set_capacity(n);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> bool SmallArray<T, N, Growth, Alloc>::resize(size_t n)
+	{
+		if(n > buffer.size() && !grow(n))
+		{
+			return false;
+		}
+
+		for(size_t i = count; i < n; ++i)
+		{
+			new(&buffer.data()[i]) T();
+		}
+
+		if(n < count)
+		{
+			hidden::destroy(&buffer.data()[n], count - n);
+		}
+
+		count = n;
+		return true;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> void SmallArray<T, N, Growth, Alloc>::clear()
+	{
+		hidden::destroy(buffer.data(), count);
+		count = 0;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T* SmallArray<T, N, Growth, Alloc>::push(const T& value)
+	{
+		if(count == buffer.size())
+		{
+			// value may refer to an element which is about to be moved
+			T copy(value);
+			return emplace(std::move(copy));
+		}
+		return emplace(value);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T* SmallArray<T, N, Growth, Alloc>::push(T&& value)
+	{
+		return emplace(std::move(value));
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc>
+	template<typename... Args> T* SmallArray<T, N, Growth, Alloc>::emplace(Args&&... args)
+	{
+		if(count == buffer.size() && !grow(count + 1))
+		{
+			return nullptr;
+		}
+
+		T* t = new(&buffer.data()[count]) T(std::forward<Args>(args)...);
+		++count;
+		return t;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> void SmallArray<T, N, Growth, Alloc>::pop()
+	{
+		RCOM_ASSERT(count > 0, "Pop from empty array");
+
+		--count;
+		buffer.data()[count].~T();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> size_t SmallArray<T, N, Growth, Alloc>::size() const
+	{
+		return count;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> size_t SmallArray<T, N, Growth, Alloc>::capacity() const
+	{
+		return buffer.size();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> size_t SmallArray<T, N, Growth, Alloc>::byte_size() const
+	{
+		return ::byte_size<T>(count);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> bool SmallArray<T, N, Growth, Alloc>::is_inline() const
+	{
+		return buffer.data() == local.arr.data();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> Alloc& SmallArray<T, N, Growth, Alloc>::allocator()
+	{
+		return alloc;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> const Alloc& SmallArray<T, N, Growth, Alloc>::allocator() const
+	{
+		return alloc;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> SmallArray<T, N, Growth, Alloc>::operator ArrayPtr<T>()
+	{
+		return to_ptr();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> SmallArray<T, N, Growth, Alloc>::operator ArrayPtr<const T>() const
+	{
+		return {buffer.data(), count};
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<T> SmallArray<T, N, Growth, Alloc>::to_ptr()
+	{
+		return {buffer.data(), count};
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<const T> SmallArray<T, N, Growth, Alloc>::to_ptr() const
+	{
+		return {buffer.data(), count};
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> BytePtr SmallArray<T, N, Growth, Alloc>::to_bytes()
+	{
+		return to_ptr().to_bytes();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<const uint8_t> SmallArray<T, N, Growth, Alloc>::to_bytes() const
+	{
+		ArrayPtr<const T> p = to_ptr();
+
+		return {reinterpret_cast<const uint8_t*>(p.data()), p.byte_size()};
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<const T> SmallArray<T, N, Growth, Alloc>::slice(size_t start, size_t end) const
+	{
+		return to_ptr().slice(start, end);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<T> SmallArray<T, N, Growth, Alloc>::slice(size_t start, size_t end)
+	{
+		return to_ptr().slice(start, end);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<const T> SmallArray<T, N, Growth, Alloc>::slice(size_t start) const
+	{
+		return to_ptr().slice(start);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<T> SmallArray<T, N, Growth, Alloc>::slice(size_t start)
+	{
+		return to_ptr().slice(start);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<const uint8_t> SmallArray<T, N, Growth, Alloc>::byte_slice(size_t start, size_t end) const
+	{
+		ArrayPtr<const T> p = slice(start, end);
+
+		return {reinterpret_cast<const uint8_t*>(p.data()), p.byte_size()};
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> BytePtr SmallArray<T, N, Growth, Alloc>::byte_slice(size_t start, size_t end)
+	{
+		return to_ptr().byte_slice(start, end);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> ArrayPtr<const uint8_t> SmallArray<T, N, Growth, Alloc>::byte_slice(size_t start) const
+	{
+		return byte_slice(start, count);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> BytePtr SmallArray<T, N, Growth, Alloc>::byte_slice(size_t start)
+	{
+		return to_ptr().byte_slice(start);
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T& SmallArray<T, N, Growth, Alloc>::operator[](size_t i)
+	{
+		RCOM_ASSERT(i < count, "Index out of range");
+		return buffer.data()[i];
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> const T& SmallArray<T, N, Growth, Alloc>::operator[](size_t i) const
+	{
+		RCOM_ASSERT(i < count, "Index out of range");
+		return buffer.data()[i];
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T* SmallArray<T, N, Growth, Alloc>::data()
+	{
+		return buffer.data();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> const T* SmallArray<T, N, Growth, Alloc>::data() const
+	{
+		return buffer.data();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T* SmallArray<T, N, Growth, Alloc>::begin()
+	{
+		return buffer.data();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> const T* SmallArray<T, N, Growth, Alloc>::begin() const
+	{
+		return buffer.data();
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T* SmallArray<T, N, Growth, Alloc>::end()
+	{
+		return buffer.data() + count;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> const T* SmallArray<T, N, Growth, Alloc>::end() const
+	{
+		return buffer.data() + count;
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T& SmallArray<T, N, Growth, Alloc>::first()
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[0];
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> const T& SmallArray<T, N, Growth, Alloc>::first() const
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[0];
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> T& SmallArray<T, N, Growth, Alloc>::last()
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[count - 1];
+	}
+
+	template<typename T, size_t N, typename Growth, typename Alloc> const T& SmallArray<T, N, Growth, Alloc>::last() const
+	{
+		RCOM_ASSERT(count > 0, "Index out of range");
+		return buffer.data()[count - 1];
+	}
+}
+// namespace::rcom
@@ -0,0 +1,481 @@
+#pragma once
+
+// Structure of arrays containers
+//
+// Each field is stored in its own contiguous column, so a loop over one field only pulls that field through the cache and can be vectorised.
+// Fields are tag types naming the column and its element type:
+//
+//   RCOM_SOA_FIELD(Position, float);
+//   RCOM_SOA_FIELD(Mass,     float);
+//   rcom::SoaArray<1024, Position, Mass> particles;
+//   rcom::ArrayPtr<float> mass = particles.column<Mass>();
+//   particles[i].get<Position>() += 1.0f;
+
+#include "array.hpp"
+#include "dynamic_array.hpp"
+#include <tuple>
+#include <utility>
+
+// Declare a field tag NAME holding elements of TYPE
+#define RCOM_SOA_FIELD(NAME, TYPE) struct NAME : rcom::SoaField<TYPE> {}
+
+namespace rcom
+{
+	template<typename T> struct SoaField
+	{
+		typedef T type;
+	};
+
+	namespace hidden
+	{
+		// Position of field F in Fields
+		template<typename F, typename... Fields> struct SoaIndex;
+
+		template<typename F, typename... Fields> struct SoaIndex<F, F, Fields...> : std::integral_constant<size_t, 0> {};
+
+		template<typename F, typename G, typename... Fields> struct SoaIndex<F, G, Fields...> :
+			std::integral_constant<size_t, 1 + SoaIndex<F, Fields...>::value> {};
+
+		// Call func(i) for each index in the sequence
+		template<typename Func, size_t... I> inline void for_each_index(Func&& func, std::index_sequence<I...>)
+		{
+			int expand[] = {0, (func(std::integral_constant<size_t, I>{}), 0)...};
+			(void)expand;
+		}
+	}
+	// namespace hidden
+
+	// One element of every column. Refers into the container, it holds no values itself
+	template<typename... Fields> class SoaRow
+	{
+	public:
+		inline explicit SoaRow(typename Fields::type*... ptrs);
+
+		template<typename F> inline       typename F::type& get();
+		template<typename F> inline const typename F::type& get() const;
+
+	private:
+		std::tuple<typename Fields::type*...> ptrs;
+	};
+
+	// Read only row, returned by the const containers
+	template<typename... Fields> class SoaConstRow
+	{
+	public:
+		inline explicit SoaConstRow(const typename Fields::type*... ptrs);
+
+		template<typename F> inline const typename F::type& get() const;
+
+	private:
+		std::tuple<const typename Fields::type*...> ptrs;
+	};
+
+	// Fixed size structure of arrays, one Array per field
+	template<size_t N, typename... Fields> class SoaArray
+	{
+	public:
+		static_assert(sizeof...(Fields) > 0, "SoaArray needs at least one field");
+
+		inline static constexpr size_t size();
+
+		template<typename F> inline ArrayPtr<typename F::type>       column();
+		template<typename F> inline ArrayPtr<const typename F::type> column() const;
+
+		inline SoaRow<Fields...>      operator[](size_t i);
+		inline SoaConstRow<Fields...> operator[](size_t i) const;
+
+	private:
+		std::tuple<Array<typename Fields::type, N>...> columns;
+
+		template<size_t... I> inline SoaRow<Fields...>      row(size_t i, std::index_sequence<I...>);
+		template<size_t... I> inline SoaConstRow<Fields...> row(size_t i, std::index_sequence<I...>) const;
+	};
+
+	// Growable structure of arrays
+	// All columns share one allocation, each starting on its own cache line
+	template<typename Growth, typename Alloc, typename... Fields> class BasicDynamicSoaArray
+	{
+	public:
+		static_assert(sizeof...(Fields) > 0, "DynamicSoaArray needs at least one field");
+
+		inline BasicDynamicSoaArray();
+		inline explicit BasicDynamicSoaArray(Alloc a);
+		inline BasicDynamicSoaArray(BasicDynamicSoaArray&& other);
+		inline BasicDynamicSoaArray& operator=(BasicDynamicSoaArray&& other);
+		inline ~BasicDynamicSoaArray();
+
+		BasicDynamicSoaArray(const BasicDynamicSoaArray&)            = delete;
+		BasicDynamicSoaArray& operator=(const BasicDynamicSoaArray&) = delete;
+
+		inline size_t size()     const;
+		inline size_t capacity() const;
+
+		inline       Alloc& allocator();
+		inline const Alloc& allocator() const;
+
+		template<typename F> inline ArrayPtr<typename F::type>       column();
+		template<typename F> inline ArrayPtr<const typename F::type> column() const;
+
+		inline SoaRow<Fields...>      operator[](size_t i);
+		inline SoaConstRow<Fields...> operator[](size_t i) const;
+
+		// Append one value per field, in field order. Return false if memory could not be allocated
+		inline bool push(const typename Fields::type&... values);
+		inline void pop();
+
+		// Return false if memory could not be allocated
+		inline bool reserve(size_t n);
+		inline bool resize(size_t n);
+		inline void clear();
+	private:
+		std::tuple<typename Fields::type*...> columns;
+		BytePtr                               buffer;
+		size_t                                count;
+		size_t                                cap;
+		Alloc                                 alloc;
+
+		// Columns start on cache lines, or stricter if a field needs it
+		static constexpr size_t column_align();
+
+		template<size_t... I> inline SoaRow<Fields...>      row(size_t i, std::index_sequence<I...>);
+		template<size_t... I> inline SoaConstRow<Fields...> row(size_t i, std::index_sequence<I...>) const;
+		template<size_t... I> inline void construct(size_t i, std::index_sequence<I...>, const typename Fields::type&... values);
+
+		inline bool grow(size_t required);
+		inline bool set_capacity(size_t n);
+		inline void release();
+	};
+
+	template<typename... Fields> using DynamicSoaArray = BasicDynamicSoaArray<GrowDouble, MallocAllocator, Fields...>;
+
+	template<typename... Fields> SoaRow<Fields...>::SoaRow(typename Fields::type*... p) :
+		ptrs{p...}
+	{
+	}
+
+	template<typename... Fields>
+	template<typename F> typename F::type& SoaRow<Fields...>::get()
+	{
+		return *std::get<hidden::SoaIndex<F, Fields...>::value>(ptrs);
+	}
+
+	template<typename... Fields>
+	template<typename F> const typename F::type& SoaRow<Fields...>::get() const
+	{
+		return *std::get<hidden::SoaIndex<F, Fields...>::value>(ptrs);
+	}
+
+	template<typename... Fields> SoaConstRow<Fields...>::SoaConstRow(const typename Fields::type*... p) :
+		ptrs{p...}
+	{
+	}
+
+	template<typename... Fields>
+	template<typename F> const typename F::type& SoaConstRow<Fields...>::get() const
+	{
+		return *std::get<hidden::SoaIndex<F, Fields...>::value>(ptrs);
+	}
+
+	template<size_t N, typename... Fields> constexpr size_t SoaArray<N, Fields...>::size()
+	{
+		return N;
+	}
+
+	template<size_t N, typename... Fields>
+	template<typename F> ArrayPtr<typename F::type> SoaArray<N, Fields...>::column()
+	{
+		return std::get<hidden::SoaIndex<F, Fields...>::value>(columns).to_ptr();
+	}
+
+	template<size_t N, typename... Fields>
+	template<typename F> ArrayPtr<const typename F::type> SoaArray<N, Fields...>::column() const
+	{
+		return std::get<hidden::SoaIndex<F, Fields...>::value>(columns).to_ptr();
+	}
+
+	template<size_t N, typename... Fields>
+	template<size_t... I> SoaRow<Fields...> SoaArray<N, Fields...>::row(size_t i, std::index_sequence<I...>)
+	{
+		return SoaRow<Fields...>{&std::get<I>(columns)[i]...};
+	}
+
+	template<size_t N, typename... Fields>
+	template<size_t... I> SoaConstRow<Fields...> SoaArray<N, Fields...>::row(size_t i, std::index_sequence<I...>) const
+	{
+		return SoaConstRow<Fields...>{&std::get<I>(columns)[i]...};
+	}
+
+	template<size_t N, typename... Fields> SoaRow<Fields...> SoaArray<N, Fields...>::operator[](size_t i)
+	{
+		RCOM_ASSERT(i < N, "Index out of range");
+		return row(i, std::index_sequence_for<Fields...>{});
+	}
+
+	template<size_t N, typename... Fields> SoaConstRow<Fields...> SoaArray<N, Fields...>::operator[](size_t i) const
+	{
+		RCOM_ASSERT(i < N, "Index out of range");
+		return row(i, std::index_sequence_for<Fields...>{});
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> BasicDynamicSoaArray<Growth, Alloc, Fields...>::BasicDynamicSoaArray() :
+		columns{},
+		buffer{},
+		count{0},
+		cap{0},
+		alloc{}
+	{
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> BasicDynamicSoaArray<Growth, Alloc, Fields...>::BasicDynamicSoaArray(Alloc a) :
+		columns{},
+		buffer{},
+		count{0},
+		cap{0},
+		alloc{a}
+	{
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	BasicDynamicSoaArray<Growth, Alloc, Fields...>::BasicDynamicSoaArray(BasicDynamicSoaArray&& other) :
+		columns{other.columns},
+		buffer{other.buffer},
+		count{other.count},
+		cap{other.cap},
+		alloc{other.alloc}
+	{
+		other.columns = {};
+		other.buffer  = nullptr;
+		other.count   = 0;
+		other.cap     = 0;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	auto BasicDynamicSoaArray<Growth, Alloc, Fields...>::operator=(BasicDynamicSoaArray&& other) -> BasicDynamicSoaArray&
+	{
+		if(this != &other)
+		{
+			release();
+
+			columns = other.columns;
+			buffer  = other.buffer;
+			count   = other.count;
+			cap     = other.cap;
+			alloc   = other.alloc;
+
+			other.columns = {};
+			other.buffer  = nullptr;
+			other.count   = 0;
+			other.cap     = 0;
+		}
+		return *this;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> BasicDynamicSoaArray<Growth, Alloc, Fields...>::~BasicDynamicSoaArray()
+	{
+		release();
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> size_t BasicDynamicSoaArray<Growth, Alloc, Fields...>::size() const
+	{
+		return count;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> size_t BasicDynamicSoaArray<Growth, Alloc, Fields...>::capacity() const
+	{
+		return cap;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> Alloc& BasicDynamicSoaArray<Growth, Alloc, Fields...>::allocator()
+	{
+		return alloc;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> const Alloc& BasicDynamicSoaArray<Growth, Alloc, Fields...>::allocator() const
+	{
+		return alloc;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	template<typename F> ArrayPtr<typename F::type> BasicDynamicSoaArray<Growth, Alloc, Fields...>::column()
+	{
+		return {std::get<hidden::SoaIndex<F, Fields...>::value>(columns), count};
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	template<typename F> ArrayPtr<const typename F::type> BasicDynamicSoaArray<Growth, Alloc, Fields...>::column() const
+	{
+		return {std::get<hidden::SoaIndex<F, Fields...>::value>(columns), count};
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	template<size_t... I> SoaRow<Fields...> BasicDynamicSoaArray<Growth, Alloc, Fields...>::row(size_t i, std::index_sequence<I...>)
+	{
+		return SoaRow<Fields...>{(std::get<I>(columns) + i)...};
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	template<size_t... I> SoaConstRow<Fields...> BasicDynamicSoaArray<Growth, Alloc, Fields...>::row(size_t i, std::index_sequence<I...>) const
+	{
+		return SoaConstRow<Fields...>{(std::get<I>(columns) + i)...};
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> SoaRow<Fields...> BasicDynamicSoaArray<Growth, Alloc, Fields...>::operator[](size_t i)
+	{
+		RCOM_ASSERT(i < count, "Index out of range");
+		return row(i, std::index_sequence_for<Fields...>{});
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	SoaConstRow<Fields...> BasicDynamicSoaArray<Growth, Alloc, Fields...>::operator[](size_t i) const
+	{
+		RCOM_ASSERT(i < count, "Index out of range");
+		return row(i, std::index_sequence_for<Fields...>{});
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields>
+	template<size_t... I> void BasicDynamicSoaArray<Growth, Alloc, Fields...>::construct(size_t i, std::index_sequence<I...>, const typename Fields::type&... values)
+	{
+		int expand[] = {0, (new(std::get<I>(columns) + i) typename Fields::type(values), 0)...};
+		(void)expand;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> bool BasicDynamicSoaArray<Growth, Alloc, Fields...>::push(const typename Fields::type&... values)
+	{
+		if(count == cap && !grow(count + 1))
+		{
+			return false;
+		}
+
+		construct(count, std::index_sequence_for<Fields...>{}, values...);
+		++count;
+		return true;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> void BasicDynamicSoaArray<Growth, Alloc, Fields...>::pop()
+	{
+		RCOM_ASSERT(count > 0, "Pop from empty array");
+
+		--count;
+
+		hidden::for_each_index([&](auto i)
+		{
+			hidden::destroy(std::get<i>(columns) + count, 1);
+		}, std::index_sequence_for<Fields...>{});
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> bool BasicDynamicSoaArray<Growth, Alloc, Fields...>::reserve(size_t n)
+	{
+		return n <= cap || set_capacity(n);
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> bool BasicDynamicSoaArray<Growth, Alloc, Fields...>::resize(size_t n)
+	{
+		if(n > cap && !set_capacity(n))
+		{
+			return false;
+		}
+
+		hidden::for_each_index([&](auto i)
+		{
+			typedef typename std::remove_pointer<typename std::tuple_element<i, decltype(columns)>::type>::type T;
+			T* p = std::get<i>(columns);
+
+			if(n < count)
+			{
+				hidden::destroy(p + n, count - n);
+			}
+
+			for(size_t j = count; j < n; ++j)
+			{
+				new(p + j) T();
+			}
+		}, std::index_sequence_for<Fields...>{});
+
+		count = n;
+		return true;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> void BasicDynamicSoaArray<Growth, Alloc, Fields...>::clear()
+	{
+		hidden::for_each_index([&](auto i)
+		{
+			hidden::destroy(std::get<i>(columns), count);
+		}, std::index_sequence_for<Fields...>{});
+
+		count = 0;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> constexpr size_t BasicDynamicSoaArray<Growth, Alloc, Fields...>::column_align()
+	{
+		size_t align = RCOM_CACHE_LINE_SIZE;
+		size_t field[] = {alignof(typename Fields::type)...};
+
+		for(size_t a : field)
+		{
+			align = a > align ? a : align;
+		}
+		return align;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> bool BasicDynamicSoaArray<Growth, Alloc, Fields...>::grow(size_t required)
+	{
+		return set_capacity(Growth::grow(cap, required));
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> bool BasicDynamicSoaArray<Growth, Alloc, Fields...>::set_capacity(size_t n)
+	{
+		const size_t align = column_align();
+
+		// Each column rounded up to whole alignment units so the next one starts aligned
+		size_t bytes[]  = {(::byte_size<typename Fields::type>(n) + align - 1) & ~(align - 1)...};
+		size_t total    = 0;
+
+		for(size_t b : bytes)
+		{
+			total += b;
+		}
+
+		BytePtr mem = alloc.allocate(total, align);
+
+		if(!mem)
+		{
+			return false;
+		}
+
+		size_t offset = 0;
+
+		hidden::for_each_index([&](auto i)
+		{
+			typedef typename std::remove_pointer<typename std::tuple_element<i, decltype(columns)>::type>::type T;
+			T* p = reinterpret_cast<T*>(mem.data() + offset);
+
+			hidden::relocate(p, std::get<i>(columns), count);
+			std::get<i>(columns) = p;
+			offset += bytes[i];
+		}, std::index_sequence_for<Fields...>{});
+
+		if(buffer)
+		{
+			alloc.deallocate(buffer, align);
+		}
+
+		buffer = mem;
+		cap    = n;
+		return true;
+	}
+
+	template<typename Growth, typename Alloc, typename... Fields> void BasicDynamicSoaArray<Growth, Alloc, Fields...>::release()
+	{
+		clear();
+
+		if(buffer)
+		{
+			alloc.deallocate(buffer, column_align());
+		}
+
+		columns = {};
+		buffer  = nullptr;
+		cap     = 0;
+	}
+}
+// namespace::rcom
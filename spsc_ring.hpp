@@ -0,0 +1,257 @@
+#pragma once
+
+// Lock free single producer single consumer ring buffer over caller provided storage
+//
+// One thread pushes and one thread pops. Neither ever blocks or takes a lock.
+// The producer and consumer indices live on separate cache lines, and each side keeps a cached copy of the other's index
+// so it only touches the shared line when the ring looks full or empty.
+
+#include "array_ptr.hpp"
+#include <atomic>
+
+namespace rcom
+{
+	template<typename T> class SpscRing
+	{
+	public:
+		// Capacity is storage.size(), which must be a power of two. Elements are assigned, not constructed
+		inline explicit SpscRing(ArrayPtr<T> storage);
+
+		SpscRing(const SpscRing&)            = delete;
+		SpscRing& operator=(const SpscRing&) = delete;
+
+		inline size_t capacity() const;
+		// Approximate when called while the other thread is active
+		inline size_t size()     const;
+		inline bool   empty()    const;
+
+		// Producer. Return false if the ring is full
+		inline bool try_push(const T& value);
+		inline bool try_push(T&& value);
+		// Copy as many values as fit, return the number pushed
+		inline size_t push(ArrayPtr<const T> values);
+
+		// Consumer. Return false if the ring is empty
+		inline bool try_pop(T& out);
+		// Pop up to out.size() values, return the number popped
+		inline size_t pop(ArrayPtr<T> out);
+
+		// Zero copy producer access. Fill some of the returned span, then commit how many were written
+		// The span stops at the end of the storage, so call again after committing to reach the wrapped part
+		inline ArrayPtr<T> write_span(size_t max = SIZE_MAX);
+		inline void        commit_write(size_t n);
+
+		// Zero copy consumer access. Read some of the returned span, then commit how many were consumed
+		inline ArrayPtr<T> read_span(size_t max = SIZE_MAX);
+		inline void        commit_read(size_t n);
+	private:
+		// Owned by the producer
+		struct alignas(RCOM_CACHE_LINE_SIZE) Producer
+		{
+			std::atomic<size_t> tail;
+			size_t              head_cache;
+		};
+
+		// Owned by the consumer
+		struct alignas(RCOM_CACHE_LINE_SIZE) Consumer
+		{
+			std::atomic<size_t> head;
+			size_t              tail_cache;
+		};
+
+		Producer    producer;
+		Consumer    consumer;
+		ArrayPtr<T> slots;
+		size_t      mask;
+
+		inline size_t writable(size_t want);
+		inline size_t readable(size_t want);
+	};
+
+	template<typename T> SpscRing<T>::SpscRing(ArrayPtr<T> storage) :
+		slots{storage},
+		mask{storage.size() - 1}
+	{
+		RCOM_ASSERT(storage, "Null pointer");
+		RCOM_ASSERT((storage.size() & mask) == 0, "Ring capacity must be a power of two");
+
+		producer.tail.store(0, std::memory_order_relaxed);
+		producer.head_cache = 0;
+		consumer.head.store(0, std::memory_order_relaxed);
+		consumer.tail_cache = 0;
+	}
+
+	template<typename T> size_t SpscRing<T>::capacity() const
+	{
+		return slots.size();
+	}
+
+	template<typename T> size_t SpscRing<T>::size() const
+	{
+		size_t head = consumer.head.load(std::memory_order_acquire);
+		size_t tail = producer.tail.load(std::memory_order_acquire);
+		return tail - head;
+	}
+
+	template<typename T> bool SpscRing<T>::empty() const
+	{
+		return size() == 0;
+	}
+
+	// Free slots seen by the producer. Only reloads the consumer index when the cached one shows fewer than wanted
+	template<typename T> size_t SpscRing<T>::writable(size_t want)
+	{
+		size_t tail = producer.tail.load(std::memory_order_relaxed);
+		size_t free = slots.size() - (tail - producer.head_cache);
+
+		if(free < want)
+		{
+			producer.head_cache = consumer.head.load(std::memory_order_acquire);
+			free                = slots.size() - (tail - producer.head_cache);
+		}
+		return free;
+	}
+
+	// Filled slots seen by the consumer. Only reloads the producer index when the cached one shows fewer than wanted
+	template<typename T> size_t SpscRing<T>::readable(size_t want)
+	{
+		size_t head = consumer.head.load(std::memory_order_relaxed);
+		size_t full = consumer.tail_cache - head;
+
+		if(full < want)
+		{
+			consumer.tail_cache = producer.tail.load(std::memory_order_acquire);
+			full                = consumer.tail_cache - head;
+		}
+		return full;
+	}
+
+	template<typename T> bool SpscRing<T>::try_push(const T& value)
+	{
+		if(writable(1) == 0)
+		{
+			return false;
+		}
+
+		size_t tail = producer.tail.load(std::memory_order_relaxed);
+		slots.data()[tail & mask] = value;
+		producer.tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T> bool SpscRing<T>::try_push(T&& value)
+	{
+		if(writable(1) == 0)
+		{
+			return false;
+		}
+
+		size_t tail = producer.tail.load(std::memory_order_relaxed);
+		slots.data()[tail & mask] = std::move(value);
+		producer.tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T> size_t SpscRing<T>::push(ArrayPtr<const T> values)
+	{
+		size_t done = 0;
+
+		// At most two spans, before and after the wrap
+		while(done < values.size())
+		{
+			ArrayPtr<T> span = write_span(values.size() - done);
+
+			if(!span)
+			{
+				break;
+			}
+
+			for(size_t i = 0; i < span.size(); ++i)
+			{
+				span.data()[i] = values.data()[done + i];
+			}
+
+			commit_write(span.size());
+			done += span.size();
+		}
+		return done;
+	}
+
+	template<typename T> bool SpscRing<T>::try_pop(T& out)
+	{
+		if(readable(1) == 0)
+		{
+			return false;
+		}
+
+		size_t head = consumer.head.load(std::memory_order_relaxed);
+		out         = std::move(slots.data()[head & mask]);
+		consumer.head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T> size_t SpscRing<T>::pop(ArrayPtr<T> out)
+	{
+		size_t done = 0;
+
+		while(done < out.size())
+		{
+			ArrayPtr<T> span = read_span(out.size() - done);
+
+			if(!span)
+			{
+				break;
+			}
+
+			for(size_t i = 0; i < span.size(); ++i)
+			{
+				out.data()[done + i] = std::move(span.data()[i]);
+			}
+
+			commit_read(span.size());
+			done += span.size();
+		}
+		return done;
+	}
+
+	template<typename T> ArrayPtr<T> SpscRing<T>::write_span(size_t max)
+	{
+		size_t free  = writable(max < slots.size() ? max : slots.size());
+		size_t start = producer.tail.load(std::memory_order_relaxed) & mask;
+		size_t n     = slots.size() - start;
+
+		n = n < free ? n : free;
+		n = n < max  ? n : max;
+		return n ? ArrayPtr<T>{slots.data() + start, n} : ArrayPtr<T>{};
+	}
+
+	template<typename T> void SpscRing<T>::commit_write(size_t n)
+	{
+		size_t tail = producer.tail.load(std::memory_order_relaxed);
+
+		RCOM_ASSERT(tail + n - producer.head_cache <= slots.size(), "Committed more than was free");
+
+		producer.tail.store(tail + n, std::memory_order_release);
+	}
+
+	template<typename T> ArrayPtr<T> SpscRing<T>::read_span(size_t max)
+	{
+		size_t full  = readable(max < slots.size() ? max : slots.size());
+		size_t start = consumer.head.load(std::memory_order_relaxed) & mask;
+		size_t n     = slots.size() - start;
+
+		n = n < full ? n : full;
+		n = n < max  ? n : max;
+		return n ? ArrayPtr<T>{slots.data() + start, n} : ArrayPtr<T>{};
+	}
+
+	template<typename T> void SpscRing<T>::commit_read(size_t n)
+	{
+		size_t head = consumer.head.load(std::memory_order_relaxed);
+
+		RCOM_ASSERT(consumer.tail_cache - head >= n, "Committed more than was available");
+
+		consumer.head.store(head + n, std::memory_order_release);
+	}
+}
+// namespace::rcom
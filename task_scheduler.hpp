@@ -0,0 +1,518 @@
+#pragma once
+
+// Work stealing fork/join scheduler
+//
+// Each thread owns a Chase-Lev deque. Spawned tasks are pushed to the bottom of the spawning thread's deque,
+// idle threads steal from the top of other deques. Task frames live in an arena owned by the spawning thread,
+// groups are synced in scope order so the arena is rewound rather than freed task by task.
+
+#include "arena.hpp"
+#include "array.hpp"
+#include "dynamic_array.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Bytes of task frames each thread can have outstanding. Tasks run inline once it is full
+#if !defined(RCOM_TASK_ARENA_BYTES)
+	#define RCOM_TASK_ARENA_BYTES (256 * 1024)
+#endif
+
+// Tasks each deque can hold. Tasks run inline once it is full
+#if !defined(RCOM_TASK_DEQUE_SIZE)
+	#define RCOM_TASK_DEQUE_SIZE 1024
+#endif
+
+namespace rcom
+{
+	class TaskScheduler;
+	class TaskGroup;
+}
+// namespace::rcom
+
+namespace rcom { namespace hidden
+{
+	struct Task
+	{
+		void      (*execute)(Task* task);
+		TaskGroup* group;
+	};
+
+	template<typename Func> struct TaskImp : Task
+	{
+		Func func;
+
+		TaskImp(Func&& f, TaskGroup* g) :
+			Task{&TaskImp::run, g},
+			func{std::move(f)}
+		{
+		}
+
+		static void run(Task* task)
+		{
+			TaskImp* t = static_cast<TaskImp*>(task);
+			t->func();
+			t->~TaskImp();
+		}
+	};
+
+	// Chase-Lev deque with a fixed capacity (Le, Pop, Cohen, Zappa Nardelli 2013)
+	class WorkDeque
+	{
+	public:
+		static_assert((RCOM_TASK_DEQUE_SIZE & (RCOM_TASK_DEQUE_SIZE - 1)) == 0, "Deque size must be a power of two");
+
+		inline WorkDeque();
+
+		// Owner only. Return false if full
+		inline bool  push(Task* task);
+		inline Task* pop();
+		// Any thread
+		inline Task* steal();
+		inline bool  empty() const;
+	private:
+		alignas(RCOM_CACHE_LINE_SIZE) std::atomic<int64_t> top;
+		alignas(RCOM_CACHE_LINE_SIZE) std::atomic<int64_t> bottom;
+		Array<std::atomic<Task*>, RCOM_TASK_DEQUE_SIZE> buffer;
+	};
+
+	WorkDeque::WorkDeque() :
+		top{0},
+		bottom{0}
+	{
+	}
+
+	bool WorkDeque::push(Task* task)
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed);
+		int64_t t = top.load(std::memory_order_acquire);
+
+		if(b - t >= static_cast<int64_t>(buffer.size()))
+		{
+			return false;
+		}
+
+		buffer[b & (buffer.size() - 1)].store(task, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	Task* WorkDeque::pop()
+	{
+		int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t t = top.load(std::memory_order_relaxed);
+
+		if(t > b)
+		{
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Task* task = buffer[b & (buffer.size() - 1)].load(std::memory_order_relaxed);
+
+		if(t == b)
+		{
+			// Last task, race thieves for it
+			if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			{
+				task = nullptr;
+			}
+			bottom.store(b + 1, std::memory_order_relaxed);
+		}
+		return task;
+	}
+
+	Task* WorkDeque::steal()
+	{
+		int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t b = bottom.load(std::memory_order_acquire);
+
+		if(t >= b)
+		{
+			return nullptr;
+		}
+
+		Task* task = buffer[t & (buffer.size() - 1)].load(std::memory_order_relaxed);
+
+		if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return nullptr;
+		}
+		return task;
+	}
+
+	bool WorkDeque::empty() const
+	{
+		return bottom.load(std::memory_order_relaxed) <= top.load(std::memory_order_relaxed);
+	}
+
+	struct alignas(RCOM_CACHE_LINE_SIZE) TaskWorker
+	{
+		WorkDeque      deque;
+		Arena          arena;
+		TaskScheduler* scheduler;
+		TaskGroup*     innermost;
+		uint32_t       seed;
+	};
+
+	// Worker bound to the current thread, null outside a scheduler
+	inline TaskWorker*& current_worker()
+	{
+		static thread_local TaskWorker* worker = nullptr;
+		return worker;
+	}
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	class TaskScheduler
+	{
+	public:
+		// 0 uses one thread per hardware thread. The thread calling run() counts as one of them
+		inline explicit TaskScheduler(size_t threads = 0);
+		inline ~TaskScheduler();
+
+		TaskScheduler(const TaskScheduler&)            = delete;
+		TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+		inline size_t size() const;
+
+		// Run func on the scheduler, blocking until it and everything it spawned has finished
+		template<typename Func>
+		inline void run(Func&& func);
+	private:
+		friend class TaskGroup;
+
+		MallocAllocator                 alloc;
+		ArrayPtr<hidden::TaskWorker>    workers;
+		DynamicArray<std::thread>       threads;
+		std::mutex                      run_mutex;
+		std::mutex                      mutex;
+		std::condition_variable         wake;
+		uint64_t                        epoch;
+		std::atomic<size_t>             sleepers;
+		std::atomic<bool>               stopping;
+
+		inline void         work(hidden::TaskWorker& self);
+		inline hidden::Task* find_task(hidden::TaskWorker& self);
+		inline bool         has_work() const;
+		inline void         notify();
+	};
+
+	// Tasks spawned together and waited on together. Sync groups in the reverse order they were created
+	class TaskGroup
+	{
+	public:
+		inline TaskGroup();
+		inline ~TaskGroup();
+
+		TaskGroup(const TaskGroup&)            = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		// Outside a scheduler, or when out of room, func runs immediately
+		template<typename Func>
+		inline void spawn(Func&& func);
+
+		// Wait for every spawned task. Runs other tasks while waiting
+		inline void sync();
+	private:
+		template<typename Func> friend struct hidden::TaskImp;
+		friend class TaskScheduler;
+
+		hidden::TaskWorker* worker;
+		TaskGroup*          outer;
+		ArenaMark           mark;
+		std::atomic<size_t> pending;
+
+		inline static void execute(hidden::Task* task);
+	};
+
+	// Run a and b in parallel and wait for both
+	template<typename A, typename B> inline void fork_join(A&& a, B&& b)
+	{
+		TaskGroup group;
+		group.spawn(std::forward<B>(b));
+		a();
+		group.sync();
+	}
+
+	TaskScheduler::TaskScheduler(size_t count) :
+		alloc{},
+		workers{},
+		epoch{0},
+		sleepers{0},
+		stopping{false}
+	{
+		if(count == 0)
+		{
+			count = std::thread::hardware_concurrency();
+		}
+
+		count   = count ? count : 1;
+		workers = allocate_array<hidden::TaskWorker>(alloc, count);
+		RCOM_ASSERT(workers, "Out of memory");
+
+		for(size_t i = 0; i < workers.size(); ++i)
+		{
+			hidden::TaskWorker* w = new(&workers[i]) hidden::TaskWorker{};
+			w->arena              = Arena{alloc.allocate(RCOM_TASK_ARENA_BYTES, alignof(std::max_align_t))};
+			w->scheduler          = this;
+			w->innermost          = nullptr;
+			w->seed               = static_cast<uint32_t>(i * 2654435761u + 1);
+		}
+
+		// Worker 0 belongs to whoever calls run()
+		threads.reserve(workers.size() - 1);
+
+		for(size_t i = 1; i < workers.size(); ++i)
+		{
+			hidden::TaskWorker* w = &workers[i];
+			threads.emplace([this, w]{work(*w);});
+		}
+	}
+
+	TaskScheduler::~TaskScheduler()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping.store(true);
+			++epoch;
+		}
+
+		wake.notify_all();
+
+		for(std::thread& t : threads)
+		{
+			t.join();
+		}
+
+		for(hidden::TaskWorker& w : workers)
+		{
+			alloc.deallocate(w.arena.to_bytes(), alignof(std::max_align_t));
+			w.~TaskWorker();
+		}
+
+		deallocate_array(alloc, workers);
+	}
+
+	size_t TaskScheduler::size() const
+	{
+		return workers.size();
+	}
+
+	template<typename Func> void TaskScheduler::run(Func&& func)
+	{
+		hidden::TaskWorker*& current = hidden::current_worker();
+
+		if(current && current->scheduler == this)
+		{
+			func();
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(run_mutex);
+
+		hidden::TaskWorker* previous = current;
+		current = &workers[0];
+		func();
+		current = previous;
+	}
+
+	hidden::Task* TaskScheduler::find_task(hidden::TaskWorker& self)
+	{
+		hidden::Task* task = self.deque.pop();
+
+		if(task || workers.size() == 1)
+		{
+			return task;
+		}
+
+		// Random victim, then sweep the rest
+		self.seed ^= self.seed << 13;
+		self.seed ^= self.seed >> 17;
+		self.seed ^= self.seed << 5;
+
+		size_t start = self.seed % workers.size();
+
+		for(size_t i = 0; i < workers.size(); ++i)
+		{
+			hidden::TaskWorker& victim = workers[(start + i) % workers.size()];
+
+			if(&victim != &self && (task = victim.deque.steal()))
+			{
+				return task;
+			}
+		}
+		return nullptr;
+	}
+
+	bool TaskScheduler::has_work() const
+	{
+		for(const hidden::TaskWorker& w : workers)
+		{
+			if(!w.deque.empty())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void TaskScheduler::notify()
+	{
+		// Pairs with the fence in work() so a thread going to sleep either sees the new task or gets woken
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if(sleepers.load(std::memory_order_relaxed) > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				++epoch;
+			}
+			wake.notify_one();
+		}
+	}
+
+	void TaskScheduler::work(hidden::TaskWorker& self)
+	{
+		hidden::current_worker() = &self;
+
+		while(!stopping.load(std::memory_order_relaxed))
+		{
+			hidden::Task* task = nullptr;
+
+			for(int spin = 0; spin < 64 && !task; ++spin)
+			{
+				task = find_task(self);
+
+				if(!task)
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			if(task)
+			{
+				TaskGroup::execute(task);
+				continue;
+			}
+
+			uint64_t seen;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				seen = epoch;
+			}
+
+			sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+			if(!has_work())
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				wake.wait(lock, [&]{return epoch != seen || stopping.load(std::memory_order_relaxed);});
+			}
+
+			sleepers.fetch_sub(1, std::memory_order_relaxed);
+		}
+
+		hidden::current_worker() = nullptr;
+	}
+
+	TaskGroup::TaskGroup() :
+		worker{hidden::current_worker()},
+		outer{nullptr},
+		mark{0},
+		pending{0}
+	{
+		if(worker)
+		{
+			outer             = worker->innermost;
+			mark              = worker->arena.mark();
+			worker->innermost = this;
+		}
+	}
+
+	TaskGroup::~TaskGroup()
+	{
+		sync();
+
+		if(worker && worker->innermost == this)
+		{
+			worker->innermost = outer;
+		}
+	}
+
+	void TaskGroup::execute(hidden::Task* task)
+	{
+		// The group may be released as soon as pending reaches zero, read it first
+		TaskGroup* group = task->group;
+		task->execute(task);
+		group->pending.fetch_sub(1, std::memory_order_release);
+	}
+
+	template<typename Func> void TaskGroup::spawn(Func&& func)
+	{
+		typedef hidden::TaskImp<typename std::decay<Func>::type> Imp;
+
+		if(!worker || worker->scheduler->workers.size() == 1)
+		{
+			func();
+			return;
+		}
+
+		ArrayPtr<Imp> frame = worker->arena.allocate<Imp>(1);
+
+		if(!frame)
+		{
+			func();
+			return;
+		}
+
+		typename std::decay<Func>::type f(std::forward<Func>(func));
+		Imp* task = new(frame.data()) Imp(std::move(f), this);
+
+		pending.fetch_add(1, std::memory_order_relaxed);
+
+		if(!worker->deque.push(task))
+		{
+			execute(task);
+			return;
+		}
+
+		worker->scheduler->notify();
+	}
+
+	void TaskGroup::sync()
+	{
+		if(!worker)
+		{
+			return;
+		}
+
+		while(pending.load(std::memory_order_acquire) > 0)
+		{
+			hidden::Task* task = worker->scheduler->find_task(*worker);
+
+			if(task)
+			{
+				execute(task);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		// Frames of nested groups are already gone, only rewind if nothing newer is open
+		if(worker->innermost == this)
+		{
+			worker->arena.rewind(mark);
+		}
+	}
+}
+// namespace::rcom
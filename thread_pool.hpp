@@ -0,0 +1,191 @@
+#pragma once
+
+// Persistent pool of worker threads running batches of indexed tasks
+
+#include "dynamic_array.hpp"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace rcom
+{
+	class ThreadPool
+	{
+	public:
+		// 0 uses one thread per hardware thread. The thread calling run() counts as one of them
+		inline explicit ThreadPool(size_t threads = 0);
+		inline ~ThreadPool();
+
+		ThreadPool(const ThreadPool&)            = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Number of threads tasks run on, including the caller
+		inline size_t size() const;
+
+		// Call func(i) for every i in [0, count). Blocks until all calls have returned
+		// Called from inside a task the loop runs serially on the current thread
+		template<typename Func>
+		inline void run(size_t count, Func& func);
+	private:
+		struct Job
+		{
+			void (*invoke)(void* func, size_t i);
+			void*               func;
+			size_t              count;
+			std::atomic<size_t> next;
+		};
+
+		DynamicArray<std::thread> workers;
+		std::mutex                submit_mutex;
+		std::mutex                mutex;
+		std::condition_variable   wake;
+		std::condition_variable   idle;
+		Job*                      job;
+		uint64_t                  generation;
+		size_t                    busy;
+		bool                      stopping;
+
+		inline void        work();
+		inline static void execute(Job& j);
+		inline static bool& in_task();
+	};
+
+	ThreadPool::ThreadPool(size_t threads) :
+		job{nullptr},
+		generation{0},
+		busy{0},
+		stopping{false}
+	{
+		if(threads == 0)
+		{
+			threads = std::thread::hardware_concurrency();
+		}
+
+		workers.reserve(threads > 1 ? threads - 1 : 0);
+
+		for(size_t i = 1; i < threads; ++i)
+		{
+			workers.emplace([this]{work();});
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		wake.notify_all();
+
+		for(std::thread& t : workers)
+		{
+			t.join();
+		}
+	}
+
+	size_t ThreadPool::size() const
+	{
+		return workers.size() + 1;
+	}
+
+	bool& ThreadPool::in_task()
+	{
+		static thread_local bool flag = false;
+		return flag;
+	}
+
+	void ThreadPool::execute(Job& j)
+	{
+		bool& flag = in_task();
+		bool  was  = flag;
+		flag       = true;
+
+		for(size_t i = j.next.fetch_add(1, std::memory_order_relaxed); i < j.count; i = j.next.fetch_add(1, std::memory_order_relaxed))
+		{
+			j.invoke(j.func, i);
+		}
+
+		flag = was;
+	}
+
+	void ThreadPool::work()
+	{
+		uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(mutex);
+
+		for(;;)
+		{
+			wake.wait(lock, [&]{return stopping || generation != seen;});
+
+			if(stopping)
+			{
+				return;
+			}
+
+			seen = generation;
+
+			// The job may already be finished and gone
+			Job* j = job;
+
+			if(!j)
+			{
+				continue;
+			}
+
+			++busy;
+			lock.unlock();
+			execute(*j);
+			lock.lock();
+
+			if(--busy == 0)
+			{
+				idle.notify_all();
+			}
+		}
+	}
+
+	template<typename Func> void ThreadPool::run(size_t count, Func& func)
+	{
+		if(count == 0)
+		{
+			return;
+		}
+
+		auto invoke = [](void* f, size_t i){(*static_cast<Func*>(f))(i);};
+
+		// Nested or trivially small batches do not need the workers
+		if(workers.size() == 0 || count == 1 || in_task())
+		{
+			for(size_t i = 0; i < count; ++i)
+			{
+				func(i);
+			}
+			return;
+		}
+
+		std::lock_guard<std::mutex> submit(submit_mutex);
+
+		Job j;
+		j.invoke = invoke;
+		j.func   = static_cast<void*>(&func);
+		j.count  = count;
+		j.next.store(0, std::memory_order_relaxed);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			job = &j;
+			++generation;
+		}
+
+		wake.notify_all();
+		execute(j);
+
+		// Every index has been claimed, wait for the workers still running one
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [&]{return busy == 0;});
+		job = nullptr;
+	}
+}
+// namespace::rcom
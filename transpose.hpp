@@ -0,0 +1,496 @@
+#pragma once
+
+// Transpose, axis permute and reshape for row major arrays
+//
+// Transposes recurse on the longer side until a tile fits in L1, so both the reads and the writes stay cache friendly at every level.
+// Tiles of 4 and 8 byte elements are transposed in registers, 8x8 or 4x4 at a time.
+
+#include "array.hpp"
+#include "cpu.hpp"
+#include <type_traits>
+#include <utility>
+
+// Largest tile side, in elements, transposed without further splitting
+#if !defined(RCOM_TRANSPOSE_TILE)
+	#define RCOM_TRANSPOSE_TILE 32
+#endif
+
+// Most stack, in bytes, transpose_in_place uses for its tile buffer
+#if !defined(RCOM_TRANSPOSE_STACK_BYTES)
+	#define RCOM_TRANSPOSE_STACK_BYTES 16384
+#endif
+
+// Most axes permute_axes handles
+#if !defined(RCOM_PERMUTE_MAX_RANK)
+	#define RCOM_PERMUTE_MAX_RANK 8
+#endif
+
+namespace rcom { namespace hidden
+{
+	// Every transpose below computes dst[c * dst_stride + r] = src[r * src_stride + c] for a rows x cols source
+
+	template<typename T> inline void transpose_scalar(T* dst, size_t dst_stride, const T* src, size_t src_stride, size_t rows, size_t cols)
+	{
+		for(size_t r = 0; r < rows; ++r)
+		{
+			for(size_t c = 0; c < cols; ++c)
+			{
+				dst[c * dst_stride + r] = src[r * src_stride + c];
+			}
+		}
+	}
+
+	// Transpose the edges a block kernel of width W left over
+	template<size_t W, typename T> inline void transpose_edges(T* dst, size_t dst_stride, const T* src, size_t src_stride, size_t rows, size_t cols)
+	{
+		size_t rows_w = rows - rows % W;
+		size_t cols_w = cols - cols % W;
+
+		transpose_scalar(dst + cols_w * dst_stride, dst_stride, src + cols_w, src_stride, rows_w, cols - cols_w);
+		transpose_scalar(dst + rows_w, dst_stride, src + rows_w * src_stride, src_stride, rows - rows_w, cols);
+	}
+
+#if defined(RCOM_X86)
+	RCOM_TARGET("sse2") inline void transpose_sse2(uint32_t* dst, size_t dst_stride, const uint32_t* src, size_t src_stride, size_t rows, size_t cols)
+	{
+		for(size_t r = 0; r + 4 <= rows; r += 4)
+		{
+			for(size_t c = 0; c + 4 <= cols; c += 4)
+			{
+				const float* s = reinterpret_cast<const float*>(src + r * src_stride + c);
+				float*       d = reinterpret_cast<float*>(dst + c * dst_stride + r);
+
+				__m128 r0 = _mm_loadu_ps(s);
+				__m128 r1 = _mm_loadu_ps(s + src_stride);
+				__m128 r2 = _mm_loadu_ps(s + src_stride * 2);
+				__m128 r3 = _mm_loadu_ps(s + src_stride * 3);
+
+				_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+				_mm_storeu_ps(d,                  r0);
+				_mm_storeu_ps(d + dst_stride,     r1);
+				_mm_storeu_ps(d + dst_stride * 2, r2);
+				_mm_storeu_ps(d + dst_stride * 3, r3);
+			}
+		}
+
+		transpose_edges<4>(dst, dst_stride, src, src_stride, rows, cols);
+	}
+
+	RCOM_TARGET("sse2") inline void transpose_sse2(uint64_t* dst, size_t dst_stride, const uint64_t* src, size_t src_stride, size_t rows, size_t cols)
+	{
+		for(size_t r = 0; r + 2 <= rows; r += 2)
+		{
+			for(size_t c = 0; c + 2 <= cols; c += 2)
+			{
+				const double* s = reinterpret_cast<const double*>(src + r * src_stride + c);
+				double*       d = reinterpret_cast<double*>(dst + c * dst_stride + r);
+
+				__m128d r0 = _mm_loadu_pd(s);
+				__m128d r1 = _mm_loadu_pd(s + src_stride);
+
+				_mm_storeu_pd(d,              _mm_unpacklo_pd(r0, r1));
+				_mm_storeu_pd(d + dst_stride, _mm_unpackhi_pd(r0, r1));
+			}
+		}
+
+		transpose_edges<2>(dst, dst_stride, src, src_stride, rows, cols);
+	}
+
+	RCOM_TARGET("avx2") inline void transpose_avx2(uint32_t* dst, size_t dst_stride, const uint32_t* src, size_t src_stride, size_t rows, size_t cols)
+	{
+		for(size_t r = 0; r + 8 <= rows; r += 8)
+		{
+			for(size_t c = 0; c + 8 <= cols; c += 8)
+			{
+				const float* s = reinterpret_cast<const float*>(src + r * src_stride + c);
+				float*       d = reinterpret_cast<float*>(dst + c * dst_stride + r);
+
+				__m256 r0 = _mm256_loadu_ps(s);
+				__m256 r1 = _mm256_loadu_ps(s + src_stride);
+				__m256 r2 = _mm256_loadu_ps(s + src_stride * 2);
+				__m256 r3 = _mm256_loadu_ps(s + src_stride * 3);
+				__m256 r4 = _mm256_loadu_ps(s + src_stride * 4);
+				__m256 r5 = _mm256_loadu_ps(s + src_stride * 5);
+				__m256 r6 = _mm256_loadu_ps(s + src_stride * 6);
+				__m256 r7 = _mm256_loadu_ps(s + src_stride * 7);
+
+				// Interleave pairs of rows, then pairs of pairs, then swap 128 bit lanes
+				__m256 t0 = _mm256_unpacklo_ps(r0, r1);
+				__m256 t1 = _mm256_unpackhi_ps(r0, r1);
+				__m256 t2 = _mm256_unpacklo_ps(r2, r3);
+				__m256 t3 = _mm256_unpackhi_ps(r2, r3);
+				__m256 t4 = _mm256_unpacklo_ps(r4, r5);
+				__m256 t5 = _mm256_unpackhi_ps(r4, r5);
+				__m256 t6 = _mm256_unpacklo_ps(r6, r7);
+				__m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+				__m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+				__m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+				__m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+				_mm256_storeu_ps(d,                  _mm256_permute2f128_ps(u0, u4, 0x20));
+				_mm256_storeu_ps(d + dst_stride,     _mm256_permute2f128_ps(u1, u5, 0x20));
+				_mm256_storeu_ps(d + dst_stride * 2, _mm256_permute2f128_ps(u2, u6, 0x20));
+				_mm256_storeu_ps(d + dst_stride * 3, _mm256_permute2f128_ps(u3, u7, 0x20));
+				_mm256_storeu_ps(d + dst_stride * 4, _mm256_permute2f128_ps(u0, u4, 0x31));
+				_mm256_storeu_ps(d + dst_stride * 5, _mm256_permute2f128_ps(u1, u5, 0x31));
+				_mm256_storeu_ps(d + dst_stride * 6, _mm256_permute2f128_ps(u2, u6, 0x31));
+				_mm256_storeu_ps(d + dst_stride * 7, _mm256_permute2f128_ps(u3, u7, 0x31));
+			}
+		}
+
+		transpose_edges<8>(dst, dst_stride, src, src_stride, rows, cols);
+	}
+
+	RCOM_TARGET("avx2") inline void transpose_avx2(uint64_t* dst, size_t dst_stride, const uint64_t* src, size_t src_stride, size_t rows, size_t cols)
+	{
+		for(size_t r = 0; r + 4 <= rows; r += 4)
+		{
+			for(size_t c = 0; c + 4 <= cols; c += 4)
+			{
+				const double* s = reinterpret_cast<const double*>(src + r * src_stride + c);
+				double*       d = reinterpret_cast<double*>(dst + c * dst_stride + r);
+
+				__m256d r0 = _mm256_loadu_pd(s);
+				__m256d r1 = _mm256_loadu_pd(s + src_stride);
+				__m256d r2 = _mm256_loadu_pd(s + src_stride * 2);
+				__m256d r3 = _mm256_loadu_pd(s + src_stride * 3);
+
+				__m256d t0 = _mm256_unpacklo_pd(r0, r1);
+				__m256d t1 = _mm256_unpackhi_pd(r0, r1);
+				__m256d t2 = _mm256_unpacklo_pd(r2, r3);
+				__m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+				_mm256_storeu_pd(d,                  _mm256_permute2f128_pd(t0, t2, 0x20));
+				_mm256_storeu_pd(d + dst_stride,     _mm256_permute2f128_pd(t1, t3, 0x20));
+				_mm256_storeu_pd(d + dst_stride * 2, _mm256_permute2f128_pd(t0, t2, 0x31));
+				_mm256_storeu_pd(d + dst_stride * 3, _mm256_permute2f128_pd(t1, t3, 0x31));
+			}
+		}
+
+		transpose_edges<4>(dst, dst_stride, src, src_stride, rows, cols);
+	}
+#endif
+
+	// Pick the tile kernel by element size. Only the bits are moved, so any trivially copyable type of the right size qualifies
+	template<typename T> struct TransposeKind
+	{
+		typedef typename std::conditional<std::is_trivially_copyable<T>::value && sizeof(T) == 4, uint32_t,
+		        typename std::conditional<std::is_trivially_copyable<T>::value && sizeof(T) == 8, uint64_t, void>::type>::type type;
+	};
+
+	template<typename T> inline void transpose_tile(T* dst, size_t dst_stride, const T* src, size_t src_stride, size_t rows, size_t cols, std::true_type)
+	{
+		transpose_scalar(dst, dst_stride, src, src_stride, rows, cols);
+	}
+
+	template<typename T> inline void transpose_tile(T* dst, size_t dst_stride, const T* src, size_t src_stride, size_t rows, size_t cols, std::false_type)
+	{
+#if defined(RCOM_X86)
+		typedef typename TransposeKind<T>::type K;
+		K*       d = reinterpret_cast<K*>(dst);
+		const K* s = reinterpret_cast<const K*>(src);
+
+		if(cpu_supports(cpu_avx2))
+		{
+			return transpose_avx2(d, dst_stride, s, src_stride, rows, cols);
+		}
+		if(cpu_supports(cpu_sse2))
+		{
+			return transpose_sse2(d, dst_stride, s, src_stride, rows, cols);
+		}
+#endif
+		transpose_scalar(dst, dst_stride, src, src_stride, rows, cols);
+	}
+
+	// Cache oblivious transpose. Halve the longer side until the tile fits, keeping splits on multiples of 8 so tiles line up with the kernels
+	template<typename T> inline void transpose_strided(T* dst, size_t dst_stride, const T* src, size_t src_stride, size_t rows, size_t cols)
+	{
+		if(rows <= RCOM_TRANSPOSE_TILE && cols <= RCOM_TRANSPOSE_TILE)
+		{
+			return transpose_tile(dst, dst_stride, src, src_stride, rows, cols, std::is_void<typename TransposeKind<T>::type>{});
+		}
+
+		if(rows >= cols)
+		{
+			size_t half = (rows / 2 + 7) & ~size_t(7);
+
+			transpose_strided(dst,        dst_stride, src,                     src_stride, half,        cols);
+			transpose_strided(dst + half, dst_stride, src + half * src_stride, src_stride, rows - half, cols);
+		}
+		else
+		{
+			size_t half = (cols / 2 + 7) & ~size_t(7);
+
+			transpose_strided(dst,                     dst_stride, src,        src_stride, rows, half);
+			transpose_strided(dst + half * dst_stride, dst_stride, src + half, src_stride, rows, cols - half);
+		}
+	}
+
+	// Tile side for transpose_in_place, halved until the buffer fits RCOM_TRANSPOSE_STACK_BYTES. 0 if a single element does not fit
+	template<typename T> inline constexpr size_t in_place_tile()
+	{
+		size_t tile = RCOM_TRANSPOSE_TILE;
+
+		while(tile > 0 && tile * tile * sizeof(T) > RCOM_TRANSPOSE_STACK_BYTES)
+		{
+			tile /= 2;
+		}
+		return tile;
+	}
+
+	template<typename T> inline void transpose_in_place(T* p, size_t n, std::true_type)
+	{
+		for(size_t r = 0; r < n; ++r)
+		{
+			for(size_t c = r + 1; c < n; ++c)
+			{
+				std::swap(p[r * n + c], p[c * n + r]);
+			}
+		}
+	}
+
+	// Swap mirrored tiles through a stack buffer, transposing each on the way
+	template<typename T> inline void transpose_in_place(T* p, size_t n, std::false_type)
+	{
+		constexpr size_t tile = in_place_tile<T>();
+
+		typename std::aligned_storage<sizeof(T) * tile * tile, alignof(T)>::type storage;
+		T* tmp = reinterpret_cast<T*>(&storage);
+
+		for(size_t i = 0; i < n; i += tile)
+		{
+			size_t rows = n - i < tile ? n - i : tile;
+
+			for(size_t j = i; j < n; j += tile)
+			{
+				size_t cols = n - j < tile ? n - j : tile;
+				T*     a    = p + i * n + j;
+				T*     b    = p + j * n + i;
+
+				transpose_strided(tmp, rows, a, n, rows, cols);
+
+				if(i != j)
+				{
+					transpose_strided(a, n, b, n, cols, rows);
+				}
+
+				for(size_t c = 0; c < cols; ++c)
+				{
+					memcpy(b + c * n, tmp + c * rows, rows * sizeof(T));
+				}
+			}
+		}
+	}
+
+	// C array arguments let static_assert check sizes in templates
+	template<size_t R> inline constexpr bool is_axis_permutation(const size_t (&dst)[R], const size_t (&src)[R], const size_t (&axes)[R])
+	{
+		for(size_t i = 0; i < R; ++i)
+		{
+			if(axes[i] >= R || dst[i] != src[axes[i]])
+			{
+				return false;
+			}
+
+			for(size_t j = 0; j < i; ++j)
+			{
+				if(axes[i] == axes[j])
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	template<size_t R> inline constexpr size_t product(const size_t (&sizes)[R])
+	{
+		size_t n = 1;
+
+		for(size_t i = 0; i < R; ++i)
+		{
+			n *= sizes[i];
+		}
+		return n;
+	}
+}}
+// namespace rcom::hidden
+
+namespace rcom
+{
+	// Transpose a rows x cols row major matrix in src into dst, which becomes cols x rows
+	template<typename T> void transpose(ArrayPtr<T> dst, ArrayPtr<const typename Identity<T>::type> src, size_t rows, size_t cols)
+	{
+		RCOM_ASSERT(dst && src, "Null pointer");
+		RCOM_ASSERT(src.size() >= rows * cols && dst.size() >= rows * cols, "Array too small");
+		RCOM_ASSERT(dst.data() + rows * cols <= src.data() || src.data() + rows * cols <= dst.data(), "Arrays overlap");
+
+		hidden::transpose_strided(dst.data(), rows, src.data(), cols, rows, cols);
+	}
+
+	// Transpose an n x n row major matrix without a second buffer
+	template<typename T> void transpose_in_place(ArrayPtr<T> ptr, size_t n)
+	{
+		RCOM_ASSERT(ptr, "Null pointer");
+		RCOM_ASSERT(ptr.size() >= n * n, "Array too small");
+
+		// Elements too large for a tile on the stack are swapped one at a time
+		hidden::transpose_in_place(ptr.data(), n, std::integral_constant<bool, !std::is_trivially_copyable<T>::value || hidden::in_place_tile<T>() == 0>{});
+	}
+
+	// Reorder the axes of a row major array with the given extents
+	// Axis i of dst is axis axes[i] of src, so {1, 0} is a transpose
+	template<typename T>
+	void permute_axes(ArrayPtr<T> dst, ArrayPtr<const typename Identity<T>::type> src, ArrayPtr<const size_t> extents, ArrayPtr<const size_t> axes)
+	{
+		const size_t rank = extents.size();
+
+		RCOM_ASSERT(dst && src, "Null pointer");
+		RCOM_ASSERT(axes.size() == rank, "Need one axis per extent");
+		RCOM_ASSERT(rank > 0 && rank <= RCOM_PERMUTE_MAX_RANK, "Unsupported rank");
+
+		if(rank == 0 || rank > RCOM_PERMUTE_MAX_RANK || axes.size() != rank)
+		{
+			return;
+		}
+
+		size_t total = 1;
+
+		for(size_t i = 0; i < rank; ++i)
+		{
+			total *= extents[i];
+		}
+
+		RCOM_ASSERT(src.size() >= total && dst.size() >= total, "Array too small");
+
+		if(total == 0)
+		{
+			return;
+		}
+
+		// Strides of src axes, and extents and strides of dst axes
+		size_t src_stride[RCOM_PERMUTE_MAX_RANK];
+		size_t dst_extent[RCOM_PERMUTE_MAX_RANK];
+		size_t dst_stride[RCOM_PERMUTE_MAX_RANK];
+		// Position in dst of each src axis
+		size_t dst_axis[RCOM_PERMUTE_MAX_RANK];
+
+		for(size_t i = rank, s = 1; i-- > 0;)
+		{
+			src_stride[i] = s;
+			s            *= extents[i];
+		}
+
+		for(size_t i = 0; i < rank; ++i)
+		{
+			RCOM_ASSERT(axes[i] < rank, "Axis out of range");
+			dst_extent[i]     = extents[axes[i]];
+			dst_axis[axes[i]] = i;
+		}
+
+		for(size_t i = rank, s = 1; i-- > 0;)
+		{
+			dst_stride[i] = s;
+			s            *= dst_extent[i];
+		}
+
+		const size_t last  = rank - 1;
+		// The innermost axis stays put: copy whole rows. Otherwise each plane of the two innermost axes is a 2D transpose
+		const bool   rows  = axes[last] == last;
+		const size_t inner = dst_axis[last];
+
+		// Odometer over the dst axes not covered by the inner copy or transpose
+		size_t index[RCOM_PERMUTE_MAX_RANK] = {};
+
+		for(;;)
+		{
+			size_t s = 0;
+			size_t d = 0;
+
+			for(size_t i = 0; i < last; ++i)
+			{
+				s += index[i] * src_stride[axes[i]];
+				d += index[i] * dst_stride[i];
+			}
+
+			if(rows)
+			{
+				const T* from = src.data() + s;
+				T*       to   = dst.data() + d;
+
+				for(size_t i = 0; i < extents[last]; ++i)
+				{
+					to[i] = from[i];
+				}
+			}
+			else
+			{
+				hidden::transpose_strided(dst.data() + d, dst_stride[inner], src.data() + s, src_stride[axes[last]], dst_extent[last], extents[last]);
+			}
+
+			size_t i = last;
+
+			while(i-- > 0)
+			{
+				if(!rows && i == inner)
+				{
+					continue;
+				}
+
+				if(++index[i] < dst_extent[i])
+				{
+					break;
+				}
+				index[i] = 0;
+			}
+
+			if(i == size_t(-1))
+			{
+				return;
+			}
+		}
+	}
+
+	// Transpose a 2D Array
+	template<typename T, size_t R, size_t C> void transpose(Array<T, C, R>& dst, const Array<T, R, C>& src)
+	{
+		hidden::transpose_strided(reinterpret_cast<T*>(dst.data()), R, reinterpret_cast<const T*>(src.data()), C, R, C);
+	}
+
+	// Permute the axes of an Array, permute_axes<1, 0, 2>(dst, src)
+	// The extents of dst must be the src extents in the permuted order
+	template<size_t... AXES, typename T, size_t... DST, size_t... SRC> void permute_axes(Array<T, DST...>& dst, const Array<T, SRC...>& src)
+	{
+		static_assert(sizeof...(AXES) == sizeof...(SRC) && sizeof...(DST) == sizeof...(SRC), "Need one axis per dimension");
+		static_assert(hidden::is_axis_permutation<sizeof...(SRC)>({DST...}, {SRC...}, {AXES...}), "Axes do not map src onto dst");
+
+		const size_t extents[] = {SRC...};
+		const size_t axes[]    = {AXES...};
+
+		permute_axes(ArrayPtr<T>{reinterpret_cast<T*>(dst.data()), dst.flat_size()},
+		             ArrayPtr<const T>{reinterpret_cast<const T*>(src.data()), src.flat_size()},
+		             ArrayPtr<const size_t>{extents},
+		             ArrayPtr<const size_t>{axes});
+	}
+
+	// View an Array as another shape with the same number of elements, reshape<4, 8>(arr)
+	template<size_t... NS, typename T, size_t... MS> Array<T, NS...>& reshape(Array<T, MS...>& arr)
+	{
+		static_assert(hidden::product<sizeof...(NS)>({NS...}) == hidden::product<sizeof...(MS)>({MS...}), "Reshape must keep the element count");
+		return *reinterpret_cast<Array<T, NS...>*>(&arr);
+	}
+
+	template<size_t... NS, typename T, size_t... MS> const Array<T, NS...>& reshape(const Array<T, MS...>& arr)
+	{
+		static_assert(hidden::product<sizeof...(NS)>({NS...}) == hidden::product<sizeof...(MS)>({MS...}), "Reshape must keep the element count");
+		return *reinterpret_cast<const Array<T, NS...>*>(&arr);
+	}
+}
+// namespace::rcom
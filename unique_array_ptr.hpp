@@ -0,0 +1,210 @@
+#pragma once
+
+// ArrayPtr which owns its elements and frees them when it goes out of scope
+
+#include "allocator.hpp"
+
+namespace rcom
+{
+	template<typename T, typename Alloc = MallocAllocator> class UniqueArrayPtr
+	{
+	public:
+		inline UniqueArrayPtr();
+		inline UniqueArrayPtr(std::nullptr_t);
+		// Take ownership of constructed elements allocated with allocate_array from a
+		inline UniqueArrayPtr(ArrayPtr<T> owned, Alloc a);
+		inline UniqueArrayPtr(UniqueArrayPtr&& other);
+		inline UniqueArrayPtr& operator=(UniqueArrayPtr&& other);
+		inline ~UniqueArrayPtr();
+
+		UniqueArrayPtr(const UniqueArrayPtr&)            = delete;
+		UniqueArrayPtr& operator=(const UniqueArrayPtr&) = delete;
+
+		inline operator ArrayPtr<T>()       const;
+		inline operator ArrayPtr<const T>() const;
+		inline operator bool()              const;
+
+		inline size_t size()      const;
+		inline size_t byte_size() const;
+
+		inline       Alloc& allocator();
+		inline const Alloc& allocator() const;
+
+		inline ArrayPtr<T> to_ptr() const;
+		inline BytePtr     to_bytes() const;
+
+		inline ArrayPtr<T> slice(size_t start, size_t end) const;
+		inline ArrayPtr<T> slice(size_t start) const;
+
+		inline T& operator[](size_t i) const;
+
+		inline T* data()  const;
+		inline T* begin() const;
+		inline T* end()   const;
+
+		// Give up ownership without destroying anything. Free the result with deallocate_array
+		inline ArrayPtr<T> release();
+		// Destroy and free the elements
+		inline void        reset();
+	private:
+		ArrayPtr<T> ptr;
+		Alloc       alloc;
+	};
+
+	// count value initialized elements. Null if memory could not be allocated
+	template<typename T, typename Alloc = MallocAllocator> inline UniqueArrayPtr<T, Alloc> make_unique_array(size_t count, Alloc a = Alloc{})
+	{
+		ArrayPtr<T> mem = count ? allocate_array<T>(a, count) : ArrayPtr<T>{};
+
+		for(size_t i = 0; i < mem.size(); ++i)
+		{
+			new(&mem.data()[i]) T();
+		}
+		return {mem, a};
+	}
+
+	// Copy of src. Null if memory could not be allocated
+	template<typename T, typename Alloc = MallocAllocator> inline UniqueArrayPtr<T, Alloc> make_unique_array(ArrayPtr<const T> src, Alloc a = Alloc{})
+	{
+		ArrayPtr<T> mem = src.size() ? allocate_array<T>(a, src.size()) : ArrayPtr<T>{};
+
+		for(size_t i = 0; i < mem.size(); ++i)
+		{
+			new(&mem.data()[i]) T(src.data()[i]);
+		}
+		return {mem, a};
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::UniqueArrayPtr() :
+		ptr{},
+		alloc{}
+	{
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::UniqueArrayPtr(std::nullptr_t) :
+		ptr{},
+		alloc{}
+	{
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::UniqueArrayPtr(ArrayPtr<T> owned, Alloc a) :
+		ptr{owned},
+		alloc{a}
+	{
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::UniqueArrayPtr(UniqueArrayPtr&& other) :
+		ptr{other.ptr},
+		alloc{other.alloc}
+	{
+		other.ptr = nullptr;
+	}
+
+	template<typename T, typename Alloc> auto UniqueArrayPtr<T, Alloc>::operator=(UniqueArrayPtr&& other) -> UniqueArrayPtr&
+	{
+		if(this != &other)
+		{
+			reset();
+			ptr       = other.ptr;
+			alloc     = other.alloc;
+			other.ptr = nullptr;
+		}
+		return *this;
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::~UniqueArrayPtr()
+	{
+		reset();
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::operator ArrayPtr<T>() const
+	{
+		return ptr;
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::operator ArrayPtr<const T>() const
+	{
+		return ptr;
+	}
+
+	template<typename T, typename Alloc> UniqueArrayPtr<T, Alloc>::operator bool() const
+	{
+		return ptr;
+	}
+
+	template<typename T, typename Alloc> size_t UniqueArrayPtr<T, Alloc>::size() const
+	{
+		return ptr.size();
+	}
+
+	template<typename T, typename Alloc> size_t UniqueArrayPtr<T, Alloc>::byte_size() const
+	{
+		return ptr.byte_size();
+	}
+
+	template<typename T, typename Alloc> Alloc& UniqueArrayPtr<T, Alloc>::allocator()
+	{
+		return alloc;
+	}
+
+	template<typename T, typename Alloc> const Alloc& UniqueArrayPtr<T, Alloc>::allocator() const
+	{
+		return alloc;
+	}
+
+	template<typename T, typename Alloc> ArrayPtr<T> UniqueArrayPtr<T, Alloc>::to_ptr() const
+	{
+		return ptr;
+	}
+
+	template<typename T, typename Alloc> BytePtr UniqueArrayPtr<T, Alloc>::to_bytes() const
+	{
+		return to_ptr().to_bytes();
+	}
+
+	template<typename T, typename Alloc> ArrayPtr<T> UniqueArrayPtr<T, Alloc>::slice(size_t start, size_t end) const
+	{
+		return to_ptr().slice(start, end);
+	}
+
+	template<typename T, typename Alloc> ArrayPtr<T> UniqueArrayPtr<T, Alloc>::slice(size_t start) const
+	{
+		return to_ptr().slice(start);
+	}
+
+	template<typename T, typename Alloc> T& UniqueArrayPtr<T, Alloc>::operator[](size_t i) const
+	{
+		RCOM_ASSERT(i < ptr.size(), "Index out of range");
+		return const_cast<T*>(ptr.data())[i];
+	}
+
+	template<typename T, typename Alloc> T* UniqueArrayPtr<T, Alloc>::data() const
+	{
+		return const_cast<T*>(ptr.data());
+	}
+
+	template<typename T, typename Alloc> T* UniqueArrayPtr<T, Alloc>::begin() const
+	{
+		return data();
+	}
+
+	template<typename T, typename Alloc> T* UniqueArrayPtr<T, Alloc>::end() const
+	{
+		return data() + ptr.size();
+	}
+
+	template<typename T, typename Alloc> ArrayPtr<T> UniqueArrayPtr<T, Alloc>::release()
+	{
+		ArrayPtr<T> p = ptr;
+		ptr           = nullptr;
+		return p;
+	}
+
+	template<typename T, typename Alloc> void UniqueArrayPtr<T, Alloc>::reset()
+	{
+		hidden::destroy(ptr.data(), ptr.size());
+		deallocate_array(alloc, ptr);
+		ptr = nullptr;
+	}
+}
+// namespace::rcom